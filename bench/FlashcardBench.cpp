@@ -0,0 +1,336 @@
+// Benchmarks the flashcard store hot paths (search, image/box loading and saving) without the GUI.
+//
+// usage: FlashcardBench [generate|pack|run|all] <deckDirectory> [numTopics] [cardsPerTopic] [iterations]
+//   generate  creates numTopics x cardsPerTopic synthetic flashcards under deckDirectory
+//   pack      converts the generated topics to single file packs
+//   run       times the store operations against an existing deck
+//   all       generate followed by run
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core/utils/logger.hpp>
+
+#include <FlashcardImageCache.hpp>
+#include <FlashcardIndex.hpp>
+#include <FlashcardPack.hpp>
+#include <FlashcardStore.hpp>
+#include <PixelSwizzle.hpp>
+using namespace FlashcardStore;
+
+namespace {
+    const int vocabularySize = 1000;
+
+    std::string topicName(int topic) {
+        char name[32];
+        snprintf(name, sizeof(name), "topic-%03d", topic);
+        return name;
+    }
+
+    std::string flashcardName(int card) {
+        char name[32];
+        snprintf(name, sizeof(name), "Flashcard-bench-%07d", card);
+        return name;
+    }
+
+    std::string keywordName(int keyword) {
+        char name[32];
+        snprintf(name, sizeof(name), "keyword-%03d", keyword);
+        return name;
+    }
+
+    // keywords are drawn from a zipf distribution so a few keywords are on most cards, like real decks
+    class KeywordSampler {
+    public:
+        explicit KeywordSampler(double exponent) {
+            double sum = 0.0;
+            for (int i = 1; i <= vocabularySize; i++) {
+                sum += 1.0 / std::pow(i, exponent);
+                cumulative.push_back(sum);
+            }
+            for (double& c : cumulative) c /= sum;
+        }
+
+        int operator()(std::mt19937& rng) {
+            double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+            return static_cast<int>(std::lower_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin());
+        }
+
+    private:
+        std::vector<double> cumulative;
+    };
+
+    // a screenshot-like card: mostly white with text lines and a few flat coloured panels, which is what png sees in practice
+    cv::Mat makeSyntheticCardImage(std::mt19937& rng) {
+        static const cv::Size cardSizes[] = {
+            cv::Size(800, 400), cv::Size(640, 480), cv::Size(1280, 720), cv::Size(1920, 1080), cv::Size(3840, 2160)
+        };
+        std::discrete_distribution<int> sizeDistribution({ 30, 25, 25, 17, 3 });
+        cv::Size size = cardSizes[sizeDistribution(rng)];
+
+        cv::Mat image(size.height, size.width, CV_8UC4, cv::Scalar(255, 255, 255, 255));
+        std::uniform_int_distribution<int> colour(0, 255);
+        int panels = std::uniform_int_distribution<int>(1, 4)(rng);
+        for (int i = 0; i < panels; i++) {
+            cv::Point topLeft(std::uniform_int_distribution<int>(0, size.width - 1)(rng), std::uniform_int_distribution<int>(0, size.height - 1)(rng));
+            cv::Point bottomRight(std::uniform_int_distribution<int>(topLeft.x, size.width)(rng), std::uniform_int_distribution<int>(topLeft.y, size.height)(rng));
+            cv::rectangle(image, topLeft, bottomRight, cv::Scalar(colour(rng), colour(rng), colour(rng), 255), cv::FILLED);
+        }
+        for (int y = 30; y < size.height; y += 28) {
+            std::string line;
+            int words = std::uniform_int_distribution<int>(2, size.width / 60)(rng);
+            for (int i = 0; i < words; i++) {
+                line += std::string(std::uniform_int_distribution<int>(2, 9)(rng), static_cast<char>('a' + colour(rng) % 26)) + " ";
+            }
+            cv::putText(image, line, cv::Point(10, y), cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 0, 0, 255), 1);
+        }
+        return image;
+    }
+
+    std::vector<std::pair<cv::Point, cv::Point>> makeSyntheticBoxes(std::mt19937& rng, cv::Size size, int maxBoxes) {
+        std::vector<std::pair<cv::Point, cv::Point>> boxes;
+        int numBoxes = std::uniform_int_distribution<int>(0, maxBoxes)(rng);
+        for (int i = 0; i < numBoxes; i++) {
+            cv::Point topLeft(std::uniform_int_distribution<int>(0, size.width / 2)(rng), std::uniform_int_distribution<int>(0, size.height / 2)(rng));
+            boxes.push_back(std::make_pair(topLeft, topLeft + cv::Point(size.width / 4, size.height / 8)));
+        }
+        return boxes;
+    }
+
+    std::vector<std::string> makeSyntheticKeywords(std::mt19937& rng, KeywordSampler& sampler) {
+        std::vector<std::string> keywords;
+        int numKeywords = std::uniform_int_distribution<int>(1, 5)(rng);
+        for (int i = 0; i < numKeywords; i++) {
+            std::string keyword = keywordName(sampler(rng));
+            if (std::find(keywords.begin(), keywords.end(), keyword) == keywords.end()) {
+                keywords.push_back(keyword);
+            }
+        }
+        return keywords;
+    }
+
+    void generateDeck(const std::string& deckDirectory, int numTopics, int cardsPerTopic) {
+        std::mt19937 rng(1234);
+        KeywordSampler sampler(1.1);
+        auto start = std::chrono::steady_clock::now();
+        for (int topic = 0; topic < numTopics; topic++) {
+            for (int card = 0; card < cardsPerTopic; card++) {
+                cv::Mat image = makeSyntheticCardImage(rng);
+                saveFlashcard(deckDirectory, topicName(topic), flashcardName(card), makeSyntheticKeywords(rng, sampler),
+                    makeSyntheticBoxes(rng, image.size(), 2), makeSyntheticBoxes(rng, image.size(), 1), image);
+            }
+            std::cout << "generated " << topicName(topic) << " (" << cardsPerTopic << " cards)" << std::endl;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "generated " << numTopics * cardsPerTopic << " flashcards in " << elapsed.count() << " s" << std::endl;
+    }
+
+    std::vector<std::string> findGeneratedTopics(const std::string& deckDirectory) {
+        std::vector<std::string> topics;
+        for (const auto& dirEntry : std::filesystem::directory_iterator(deckDirectory)) {
+            if (dirEntry.is_directory() && dirEntry.path().filename().string().rfind("topic-", 0) == 0) {
+                topics.push_back(dirEntry.path().filename().string());
+            }
+        }
+        std::sort(topics.begin(), topics.end());
+        return topics;
+    }
+
+    void packDeck(const std::string& deckDirectory) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::string> topics = findGeneratedTopics(deckDirectory);
+        for (const std::string& topic : topics) {
+            FlashcardPack::convertTopicToPack(deckDirectory, topic, true);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "packed " << topics.size() << " topics in " << elapsed.count() << " s" << std::endl;
+    }
+
+    struct BenchResult {
+        std::string name;
+        std::vector<double> milliseconds;
+    };
+
+    BenchResult timeOperation(const std::string& name, int iterations, const std::function<void(int)>& operation) {
+        BenchResult result;
+        result.name = name;
+        for (int i = 0; i < iterations; i++) {
+            auto start = std::chrono::steady_clock::now();
+            operation(i);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            result.milliseconds.push_back(elapsed.count());
+        }
+        return result;
+    }
+
+    void printResult(const BenchResult& result) {
+        std::vector<double> sorted = result.milliseconds;
+        if (sorted.empty()) return;
+        std::sort(sorted.begin(), sorted.end());
+        double total = 0.0;
+        for (double ms : sorted) total += ms;
+        double p50 = sorted[sorted.size() / 2];
+        double p99 = sorted[std::min(sorted.size() - 1, static_cast<size_t>(sorted.size() * 0.99))];
+        printf("%-16s %8zu %12.1f %12.3f %12.3f\n", result.name.c_str(), sorted.size(),
+            total > 0.0 ? sorted.size() * 1000.0 / total : 0.0, p50, p99);
+    }
+
+    void runBenchmarks(const std::string& deckDirectory, int iterations) {
+        std::vector<std::string> topics = findGeneratedTopics(deckDirectory);
+        if (topics.empty()) {
+            std::cerr << "No generated topics found in " << deckDirectory << std::endl;
+            return;
+        }
+
+        std::mt19937 rng(4321);
+        KeywordSampler sampler(1.1);
+        std::vector<BenchResult> results;
+
+        results.push_back(timeOperation("index build", static_cast<int>(topics.size()), [&](int i) {
+            FlashcardIndex::buildTopicIndex(deckDirectory, topics[i]);
+        }));
+
+        std::vector<std::pair<std::string, std::string>> flashcards;
+        for (const std::string& topic : topics) {
+            for (const std::string& flashcard : searchForFlashcards(deckDirectory, topic, std::vector<std::string>())) {
+                flashcards.push_back(std::make_pair(topic, flashcard));
+            }
+        }
+        std::cout << topics.size() << " topics, " << flashcards.size() << " flashcards" << std::endl;
+        if (flashcards.empty()) return;
+
+        size_t totalFound = 0;
+        results.push_back(timeOperation("search", iterations, [&](int) {
+            std::vector<std::string> keywords;
+            int numKeywords = std::uniform_int_distribution<int>(1, 3)(rng);
+            for (int k = 0; k < numKeywords; k++) keywords.push_back(keywordName(sampler(rng)));
+            const std::string& topic = topics[rng() % topics.size()];
+            totalFound += searchForFlashcards(deckDirectory, topic, keywords).size();
+        }));
+
+        //cold loads decode every time, hot loads cycle through a 200 card session that fits in the image cache
+        FlashcardImageCache& imageCache = FlashcardImageCache::shared();
+        size_t imageCacheBudget = imageCache.stats().byteBudget;
+        imageCache.setByteBudget(0);
+        results.push_back(timeOperation("load image", iterations, [&](int) {
+            const auto& flashcard = flashcards[rng() % flashcards.size()];
+            loadFlashcardImage(deckDirectory, flashcard.first, flashcard.second);
+        }));
+        imageCache.setByteBudget(imageCacheBudget);
+        size_t sessionSize = std::min<size_t>(flashcards.size(), 200);
+        for (size_t i = 0; i < sessionSize; i++) {
+            loadFlashcardImage(deckDirectory, flashcards[i].first, flashcards[i].second);
+        }
+        results.push_back(timeOperation("load image hot", iterations, [&](int) {
+            const auto& flashcard = flashcards[rng() % sessionSize];
+            loadFlashcardImage(deckDirectory, flashcard.first, flashcard.second);
+        }));
+        FlashcardImageCache::Stats imageCacheStats = imageCache.stats();
+
+        results.push_back(timeOperation("load boxes", iterations, [&](int) {
+            const auto& flashcard = flashcards[rng() % flashcards.size()];
+            std::vector<std::pair<cv::Point, cv::Point>> answerBoxBounds;
+            std::vector<std::pair<cv::Point, cv::Point>> questionBoxBounds;
+            loadFlashcardBoxBounds(deckDirectory, flashcard.first, flashcard.second, answerBoxBounds, questionBoxBounds);
+        }));
+
+        //save into scratch topics so the generated deck stays the same between runs, one per format so both
+        //formats of the same cards stay on disk to be loaded and measured
+        const std::string saveTopic = "bench-save";
+        const std::string saveQoiTopic = "bench-save-qoi";
+        std::vector<cv::Mat> saveImages;
+        for (int i = 0; i < std::min(iterations, 16); i++) saveImages.push_back(makeSyntheticCardImage(rng));
+        results.push_back(timeOperation("save", iterations, [&](int i) {
+            cv::Mat& image = saveImages[i % saveImages.size()];
+            saveFlashcard(deckDirectory, saveTopic, flashcardName(i), makeSyntheticKeywords(rng, sampler),
+                makeSyntheticBoxes(rng, image.size(), 2), makeSyntheticBoxes(rng, image.size(), 1), image);
+        }));
+        results.push_back(timeOperation("save qoi", iterations, [&](int i) {
+            cv::Mat& image = saveImages[i % saveImages.size()];
+            saveFlashcard(deckDirectory, saveQoiTopic, flashcardName(i), makeSyntheticKeywords(rng, sampler),
+                makeSyntheticBoxes(rng, image.size(), 2), makeSyntheticBoxes(rng, image.size(), 1), image, ImageFormat::Qoi);
+        }));
+
+        //the same images decoded from either format, with the cache off so every load decodes
+        imageCache.setByteBudget(0);
+        results.push_back(timeOperation("load png", iterations, [&](int i) {
+            loadFlashcardImage(deckDirectory, saveTopic, flashcardName(static_cast<int>(i % saveImages.size())));
+        }));
+        results.push_back(timeOperation("load qoi", iterations, [&](int i) {
+            loadFlashcardImage(deckDirectory, saveQoiTopic, flashcardName(static_cast<int>(i % saveImages.size())));
+        }));
+        imageCache.setByteBudget(imageCacheBudget);
+
+        std::error_code ec;
+        auto averageImageBytes = [&](const std::string& topic) {
+            uint64_t totalBytes = 0;
+            for (size_t i = 0; i < saveImages.size(); i++) {
+                uintmax_t bytes = std::filesystem::file_size(flashcardImagePath(deckDirectory, topic, flashcardName(static_cast<int>(i))), ec);
+                if (!ec) totalBytes += bytes;
+            }
+            return saveImages.empty() ? 0 : totalBytes / saveImages.size();
+        };
+        uint64_t averagePngBytes = averageImageBytes(saveTopic);
+        uint64_t averageQoiBytes = averageImageBytes(saveQoiTopic);
+        for (const std::string& topic : { saveTopic, saveQoiTopic }) {
+            std::filesystem::remove_all(deckDirectory + "/" + topic, ec);
+            std::filesystem::remove(FlashcardIndex::indexPathForTopic(deckDirectory, topic), ec);
+        }
+
+        //the channel swap every save does before encoding, on a 4K card
+        cv::Mat swizzleSource(2160, 3840, CV_8UC4, cv::Scalar(40, 80, 120, 255));
+        cv::Mat swizzled;
+        results.push_back(timeOperation("swizzle 4k", std::min(iterations, 100), [&](int) {
+            PixelSwizzle::swapRedBlue(swizzleSource, swizzled);
+        }));
+
+        printf("%-16s %8s %12s %12s %12s\n", "operation", "count", "ops/s", "p50 (ms)", "p99 (ms)");
+        for (const BenchResult& result : results) {
+            printResult(result);
+        }
+        std::cout << "average search results: " << static_cast<double>(totalFound) / iterations << std::endl;
+        std::cout << "image cache: " << imageCacheStats.hits << " hits, " << imageCacheStats.misses << " misses, "
+            << imageCacheStats.entries << " images, " << imageCacheStats.bytes / (1024 * 1024) << " MiB" << std::endl;
+        std::cout << "average encoded image: png " << averagePngBytes / 1024 << " KiB, qoi "
+            << averageQoiBytes / 1024 << " KiB" << std::endl;
+        std::cout << "pixel swizzle: " << PixelSwizzle::implementationName() << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    cv::utils::logging::setLogLevel(cv::utils::logging::LogLevel::LOG_LEVEL_SILENT);
+
+    if (argc < 3) {
+        std::cerr << "usage: FlashcardBench [generate|pack|run|all] <deckDirectory> [numTopics] [cardsPerTopic] [iterations]" << std::endl;
+        return -1;
+    }
+    std::string mode = argv[1];
+    std::string deckDirectory = argv[2];
+    int numTopics = argc > 3 ? std::atoi(argv[3]) : 10;
+    int cardsPerTopic = argc > 4 ? std::atoi(argv[4]) : 1000;
+    int iterations = argc > 5 ? std::atoi(argv[5]) : 1000;
+    if (mode != "generate" && mode != "pack" && mode != "run" && mode != "all") {
+        std::cerr << "Unknown mode: " << mode << std::endl;
+        return -1;
+    }
+
+    if (mode == "generate" || mode == "all") {
+        generateDeck(deckDirectory, numTopics, cardsPerTopic);
+    }
+    if (mode == "pack") {
+        packDeck(deckDirectory);
+    }
+    if (mode == "run" || mode == "all") {
+        runBenchmarks(deckDirectory, iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <GL/gl3w.h>
+#include <opencv2/core.hpp>
+
+#include "imgui.h"
+
+// GL textures mirroring an RGBA cv::Mat, split into tileSize x tileSize tiles so canvases of any size stay
+// under GL_MAX_TEXTURE_SIZE. only the regions marked dirty since the last upload are re-uploaded, and only for
+// tiles that are visible; tiles scrolled out of view keep their dirty regions until they are shown again.
+// a tile's storage is reallocated only when the canvas size changes its size, and its mipmaps are rebuilt after
+// each upload so zoomed out views stay smooth
+//
+// needs a current GL context for its whole lifetime
+class CanvasTexture {
+public:
+	static const int tileSize = 512;
+
+	CanvasTexture();
+	~CanvasTexture();
+	CanvasTexture(const CanvasTexture&) = delete;
+	CanvasTexture& operator=(const CanvasTexture&) = delete;
+
+	void markDirty(const cv::Rect& region);
+	void markAllDirty();
+
+	// sends the dirty parts of the tiles overlapping visibleRegion (in canvas pixels) and returns the number of bytes uploaded
+	size_t upload(const cv::Mat& canvas, const cv::Rect& visibleRegion);
+	// draws the tiles overlapping visibleRegion with the canvas' top left at canvasPos, scaled by zoom
+	void draw(ImDrawList* drawList, ImVec2 canvasPos, float zoom, const cv::Rect& visibleRegion) const;
+
+	size_t tileCount() const { return tiles.size(); }
+
+private:
+	struct Tile {
+		GLuint texture = 0;
+		cv::Rect bounds;
+		bool allocated = false;
+		bool allDirty = true;
+		std::vector<cv::Rect> dirtyRegions;
+	};
+
+	void resize(cv::Size size);
+	void markTileDirty(Tile& tile, const cv::Rect& region);
+
+	cv::Size canvasSize;
+	std::vector<Tile> tiles;
+};
@@ -0,0 +1,130 @@
+#include "CanvasTexture.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+    //past this many regions one upload of their bounding box is cheaper than many small ones
+    const size_t maxDirtyRegions = 16;
+}
+
+CanvasTexture::CanvasTexture() {
+}
+
+CanvasTexture::~CanvasTexture() {
+    for (Tile& tile : tiles) {
+        glDeleteTextures(1, &tile.texture);
+    }
+}
+
+void CanvasTexture::resize(cv::Size size) {
+    int tileColumns = (size.width + tileSize - 1) / tileSize;
+    int tileRows = (size.height + tileSize - 1) / tileSize;
+    size_t tileTotal = static_cast<size_t>(tileColumns) * tileRows;
+
+    //texture names are kept for reuse, only tiles past the new grid are deleted
+    for (size_t i = tileTotal; i < tiles.size(); i++) {
+        glDeleteTextures(1, &tiles[i].texture);
+    }
+    tiles.resize(tileTotal);
+
+    for (int row = 0; row < tileRows; row++) {
+        for (int column = 0; column < tileColumns; column++) {
+            Tile& tile = tiles[row * tileColumns + column];
+            cv::Rect bounds(column * tileSize, row * tileSize,
+                std::min(tileSize, size.width - column * tileSize), std::min(tileSize, size.height - row * tileSize));
+            if (tile.texture == 0) {
+                glGenTextures(1, &tile.texture);
+                glBindTexture(GL_TEXTURE_2D, tile.texture);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            }
+            if (tile.bounds.size() != bounds.size()) tile.allocated = false;
+            tile.bounds = bounds;
+            tile.allDirty = true;
+            tile.dirtyRegions.clear();
+        }
+    }
+    canvasSize = size;
+}
+
+void CanvasTexture::markTileDirty(Tile& tile, const cv::Rect& region) {
+    if (tile.allDirty) return;
+    if (tile.dirtyRegions.size() == maxDirtyRegions) {
+        cv::Rect boundingRegion = region;
+        for (const cv::Rect& dirtyRegion : tile.dirtyRegions) {
+            boundingRegion |= dirtyRegion;
+        }
+        tile.dirtyRegions.clear();
+        tile.dirtyRegions.push_back(boundingRegion);
+        return;
+    }
+    tile.dirtyRegions.push_back(region);
+}
+
+void CanvasTexture::markDirty(const cv::Rect& region) {
+    if (region.empty()) return;
+    for (Tile& tile : tiles) {
+        cv::Rect tileRegion = region & tile.bounds;
+        if (!tileRegion.empty()) markTileDirty(tile, tileRegion);
+    }
+}
+
+void CanvasTexture::markAllDirty() {
+    for (Tile& tile : tiles) {
+        tile.allDirty = true;
+        tile.dirtyRegions.clear();
+    }
+}
+
+size_t CanvasTexture::upload(const cv::Mat& canvas, const cv::Rect& visibleRegion) {
+    CV_Assert(canvas.type() == CV_8UC4);
+    if (canvas.size() != canvasSize) resize(canvas.size());
+
+    size_t uploadedBytes = 0;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(canvas.step / canvas.elemSize()));
+
+    for (Tile& tile : tiles) {
+        if ((tile.bounds & visibleRegion).empty()) continue;
+        if (!tile.allDirty && tile.dirtyRegions.empty()) continue;
+
+        //tiles are views into the canvas, the row length above lets GL read them in place
+        glBindTexture(GL_TEXTURE_2D, tile.texture);
+        if (!tile.allocated) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tile.bounds.width, tile.bounds.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                canvas.ptr(tile.bounds.y, tile.bounds.x));
+            tile.allocated = true;
+            uploadedBytes += tile.bounds.area() * canvas.elemSize();
+        }
+        else if (tile.allDirty) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tile.bounds.width, tile.bounds.height, GL_RGBA, GL_UNSIGNED_BYTE,
+                canvas.ptr(tile.bounds.y, tile.bounds.x));
+            uploadedBytes += tile.bounds.area() * canvas.elemSize();
+        }
+        else {
+            for (const cv::Rect& region : tile.dirtyRegions) {
+                glTexSubImage2D(GL_TEXTURE_2D, 0, region.x - tile.bounds.x, region.y - tile.bounds.y, region.width, region.height,
+                    GL_RGBA, GL_UNSIGNED_BYTE, canvas.ptr(region.y, region.x));
+                uploadedBytes += region.area() * canvas.elemSize();
+            }
+        }
+        glGenerateMipmap(GL_TEXTURE_2D);
+        tile.allDirty = false;
+        tile.dirtyRegions.clear();
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    return uploadedBytes;
+}
+
+void CanvasTexture::draw(ImDrawList* drawList, ImVec2 canvasPos, float zoom, const cv::Rect& visibleRegion) const {
+    for (const Tile& tile : tiles) {
+        if (!tile.allocated || (tile.bounds & visibleRegion).empty()) continue;
+        ImVec2 tileMin(canvasPos.x + tile.bounds.x * zoom, canvasPos.y + tile.bounds.y * zoom);
+        drawList->AddImage(reinterpret_cast<void*>(static_cast<intptr_t>(tile.texture)), tileMin,
+            ImVec2(tileMin.x + tile.bounds.width * zoom, tileMin.y + tile.bounds.height * zoom));
+    }
+}
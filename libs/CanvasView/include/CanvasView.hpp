@@ -0,0 +1,43 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include "imgui.h"
+
+// zoom and pan of an on screen view of an image, and the mapping between image pixels and the screen.
+// ctrl+wheel zooms around the mouse and the middle mouse button pans while the mouse is over the view
+//
+// the view keeps the layout of the last frame it was laid out in, so input can be mapped to image pixels
+// before the view is laid out again
+class CanvasView {
+public:
+	static constexpr float minZoom = 1.0f / 16.0f;
+	static constexpr float maxZoom = 16.0f;
+
+	// reserves the view at the cursor, as large as the zoomed image but at most maxViewSize, and handles its input
+	void layout(cv::Size imageSize, ImVec2 maxViewSize);
+	// zooms out until the whole image fits in maxViewSize, never past 1:1
+	void fit(cv::Size imageSize, ImVec2 maxViewSize);
+	// zooms keeping the image pixel under anchor (in screen coordinates) in place
+	void setZoom(float newZoom, ImVec2 anchor);
+	float zoom() const { return zoomLevel; }
+
+	ImVec2 toScreen(cv::Point2f point) const;
+	cv::Point toImage(ImVec2 screenPoint) const;
+	// whether screenPoint is over the view and over the image in it
+	bool contains(ImVec2 screenPoint) const;
+
+	ImVec2 viewMin() const { return viewMinPos; }
+	ImVec2 viewMax() const { return viewMaxPos; }
+	// image pixels inside the view
+	cv::Rect visibleRegion() const;
+
+private:
+	void clampPan();
+
+	float zoomLevel = 1.0f;
+	ImVec2 pan = ImVec2(0.0f, 0.0f); // image origin relative to the view's top left
+	ImVec2 viewMinPos = ImVec2(0.0f, 0.0f);
+	ImVec2 viewMaxPos = ImVec2(0.0f, 0.0f);
+	cv::Size imageSize;
+};
@@ -0,0 +1,81 @@
+#include "CanvasView.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    //each wheel step zooms by this factor
+    const float wheelZoomStep = 1.25f;
+}
+
+void CanvasView::layout(cv::Size newImageSize, ImVec2 maxViewSize) {
+    imageSize = newImageSize;
+    ImVec2 viewSize(std::max(1.0f, std::min(imageSize.width * zoomLevel, maxViewSize.x)),
+        std::max(1.0f, std::min(imageSize.height * zoomLevel, maxViewSize.y)));
+    viewMinPos = ImGui::GetCursorScreenPos();
+    viewMaxPos = ImVec2(viewMinPos.x + viewSize.x, viewMinPos.y + viewSize.y);
+    ImGui::Dummy(viewSize);
+
+    if (ImGui::IsItemHovered()) {
+        ImGuiIO& io = ImGui::GetIO();
+        if (io.KeyCtrl && io.MouseWheel != 0.0f) {
+            setZoom(zoomLevel * std::pow(wheelZoomStep, io.MouseWheel), io.MousePos);
+        }
+        if (ImGui::IsMouseDown(2)) {
+            pan.x += io.MouseDelta.x;
+            pan.y += io.MouseDelta.y;
+        }
+    }
+    clampPan();
+}
+
+void CanvasView::fit(cv::Size newImageSize, ImVec2 maxViewSize) {
+    imageSize = newImageSize;
+    float fitZoom = 1.0f;
+    if (imageSize.width > 0 && imageSize.height > 0) {
+        fitZoom = std::min({ 1.0f, maxViewSize.x / imageSize.width, maxViewSize.y / imageSize.height });
+    }
+    zoomLevel = std::max(minZoom, fitZoom);
+    pan = ImVec2(0.0f, 0.0f);
+}
+
+void CanvasView::setZoom(float newZoom, ImVec2 anchor) {
+    newZoom = std::min(maxZoom, std::max(minZoom, newZoom));
+    float imageX = (anchor.x - viewMinPos.x - pan.x) / zoomLevel;
+    float imageY = (anchor.y - viewMinPos.y - pan.y) / zoomLevel;
+    zoomLevel = newZoom;
+    pan = ImVec2(anchor.x - viewMinPos.x - imageX * zoomLevel, anchor.y - viewMinPos.y - imageY * zoomLevel);
+    clampPan();
+}
+
+void CanvasView::clampPan() {
+    //an image smaller than the view sits in its top left like an unzoomed one, a larger one always covers it
+    float contentWidth = imageSize.width * zoomLevel;
+    float contentHeight = imageSize.height * zoomLevel;
+    float viewWidth = viewMaxPos.x - viewMinPos.x;
+    float viewHeight = viewMaxPos.y - viewMinPos.y;
+    pan.x = contentWidth <= viewWidth ? 0.0f : std::min(0.0f, std::max(viewWidth - contentWidth, pan.x));
+    pan.y = contentHeight <= viewHeight ? 0.0f : std::min(0.0f, std::max(viewHeight - contentHeight, pan.y));
+}
+
+ImVec2 CanvasView::toScreen(cv::Point2f point) const {
+    return ImVec2(viewMinPos.x + pan.x + point.x * zoomLevel, viewMinPos.y + pan.y + point.y * zoomLevel);
+}
+
+cv::Point CanvasView::toImage(ImVec2 screenPoint) const {
+    return cv::Point(static_cast<int>(std::floor((screenPoint.x - viewMinPos.x - pan.x) / zoomLevel)),
+        static_cast<int>(std::floor((screenPoint.y - viewMinPos.y - pan.y) / zoomLevel)));
+}
+
+bool CanvasView::contains(ImVec2 screenPoint) const {
+    if (screenPoint.x < viewMinPos.x || screenPoint.y < viewMinPos.y || screenPoint.x >= viewMaxPos.x || screenPoint.y >= viewMaxPos.y) {
+        return false;
+    }
+    return cv::Rect(0, 0, imageSize.width, imageSize.height).contains(toImage(screenPoint));
+}
+
+cv::Rect CanvasView::visibleRegion() const {
+    cv::Point topLeft = toImage(viewMinPos);
+    cv::Point bottomRight = toImage(viewMaxPos) + cv::Point(1, 1);
+    return cv::Rect(topLeft, bottomRight) & cv::Rect(0, 0, imageSize.width, imageSize.height);
+}
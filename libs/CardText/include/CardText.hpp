@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "imgui.h"
+
+// multi line card text drawn from an ImGui font's glyph atlas. the text shown while typing is a handful of
+// textured quads on the GPU, and Apply Text copies the very same atlas glyphs into the card, so what is
+// previewed is what gets saved. line layouts are cached by text so a long pasted text is only laid out once,
+// and only the lines inside the draw list's clip rect are drawn
+//
+// the font has to be rasterized 1:1 (no oversampling, pixel snapped) for rasterize() to match draw()
+class CardText {
+public:
+	explicit CardText(ImFont* font, size_t maxCachedLayouts = 8);
+
+	// pos is the bottom left of the first line, like cv::putText, and the text is scaled by scale on screen
+	void draw(ImDrawList* drawList, ImVec2 pos, const std::string& text, ImU32 color, float scale = 1.0f);
+	// blends the text into an RGBA image and returns the region drawn over
+	cv::Rect rasterize(cv::Mat& image, cv::Point pos, const std::string& text, cv::Scalar color);
+	// region covered by the text drawn at pos
+	cv::Rect region(cv::Point pos, const std::string& text);
+
+private:
+	struct Glyph {
+		ImVec2 min;
+		ImVec2 max;
+		ImVec2 uvMin;
+		ImVec2 uvMax;
+	};
+
+	struct Line {
+		float top;
+		size_t firstGlyph;
+		size_t endGlyph;
+	};
+
+	struct Layout {
+		std::string text;
+		std::vector<Glyph> glyphs;
+		std::vector<Line> lines;
+		ImVec2 size;
+	};
+
+	const Layout& layout(const std::string& text);
+
+	ImFont* font;
+	size_t maxCachedLayouts;
+	std::list<Layout> layouts; // most recently used first
+};
@@ -0,0 +1,136 @@
+#include "CardText.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+    //decodes one utf-8 character at text[i] and moves i past it, bad bytes come out as the replacement character
+    unsigned int nextCodepoint(const std::string& text, size_t& i) {
+        unsigned char c = static_cast<unsigned char>(text[i++]);
+        if (c < 0x80) return c;
+        int length = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : -1;
+        if (length < 0 || i + length > text.size()) return 0xFFFD;
+        unsigned int codepoint = c & (0x3F >> length);
+        for (int j = 0; j < length; j++) {
+            unsigned char continuation = static_cast<unsigned char>(text[i]);
+            if ((continuation & 0xC0) != 0x80) return 0xFFFD;
+            codepoint = (codepoint << 6) | (continuation & 0x3F);
+            i++;
+        }
+        return codepoint;
+    }
+}
+
+CardText::CardText(ImFont* font, size_t maxCachedLayouts)
+    : font(font), maxCachedLayouts(maxCachedLayouts) {
+}
+
+const CardText::Layout& CardText::layout(const std::string& text) {
+    for (auto cached = layouts.begin(); cached != layouts.end(); cached++) {
+        if (cached->text.size() == text.size() && cached->text == text) {
+            layouts.splice(layouts.begin(), layouts, cached);
+            return layouts.front();
+        }
+    }
+
+    Layout newLayout;
+    newLayout.text = text;
+    float lineHeight = font->FontSize;
+    const ImFontGlyph* spaceGlyph = font->FindGlyph(' ');
+    float x = 0.0f;
+    float top = 0.0f;
+    float width = 0.0f;
+    newLayout.lines.push_back({ top, 0, 0 });
+    for (size_t i = 0; i < text.size();) {
+        unsigned int codepoint = nextCodepoint(text, i);
+        if (codepoint == '\n') {
+            newLayout.lines.back().endGlyph = newLayout.glyphs.size();
+            top += lineHeight;
+            x = 0.0f;
+            newLayout.lines.push_back({ top, newLayout.glyphs.size(), newLayout.glyphs.size() });
+            continue;
+        }
+        if (codepoint == '\r') continue;
+        if (codepoint == '\t') {
+            x += spaceGlyph != nullptr ? spaceGlyph->AdvanceX * 4 : 0.0f;
+            continue;
+        }
+
+        const ImFontGlyph* glyph = font->FindGlyph(static_cast<ImWchar>(codepoint > 0xFFFF ? 0xFFFD : codepoint));
+        if (glyph == nullptr) continue;
+        if (glyph->X1 > glyph->X0 && glyph->Y1 > glyph->Y0) {
+            newLayout.glyphs.push_back({ ImVec2(x + glyph->X0, top + glyph->Y0), ImVec2(x + glyph->X1, top + glyph->Y1),
+                ImVec2(glyph->U0, glyph->V0), ImVec2(glyph->U1, glyph->V1) });
+        }
+        x += glyph->AdvanceX;
+        width = std::max(width, x);
+    }
+    newLayout.lines.back().endGlyph = newLayout.glyphs.size();
+    newLayout.size = ImVec2(width, top + lineHeight);
+
+    layouts.push_front(std::move(newLayout));
+    if (layouts.size() > maxCachedLayouts) layouts.pop_back();
+    return layouts.front();
+}
+
+void CardText::draw(ImDrawList* drawList, ImVec2 pos, const std::string& text, ImU32 color, float scale) {
+    const Layout& textLayout = layout(text);
+    ImVec2 origin(pos.x, pos.y - font->FontSize * scale);
+    ImVec2 clipMin = drawList->GetClipRectMin();
+    ImVec2 clipMax = drawList->GetClipRectMax();
+
+    //lines are stacked top to bottom, so the visible ones are one contiguous run
+    auto firstLine = std::lower_bound(textLayout.lines.begin(), textLayout.lines.end(), (clipMin.y - origin.y) / scale - font->FontSize,
+        [](const Line& line, float top) { return line.top < top; });
+    drawList->PushTextureID(font->ContainerAtlas->TexID);
+    for (auto line = firstLine; line != textLayout.lines.end() && origin.y + line->top * scale <= clipMax.y; line++) {
+        for (size_t i = line->firstGlyph; i < line->endGlyph; i++) {
+            const Glyph& glyph = textLayout.glyphs[i];
+            if (origin.x + glyph.max.x * scale < clipMin.x) continue;
+            if (origin.x + glyph.min.x * scale > clipMax.x) break;
+            drawList->PrimReserve(6, 4);
+            drawList->PrimRectUV(ImVec2(origin.x + glyph.min.x * scale, origin.y + glyph.min.y * scale),
+                ImVec2(origin.x + glyph.max.x * scale, origin.y + glyph.max.y * scale), glyph.uvMin, glyph.uvMax, color);
+        }
+    }
+    drawList->PopTextureID();
+}
+
+cv::Rect CardText::region(cv::Point pos, const std::string& text) {
+    const Layout& textLayout = layout(text);
+    return cv::Rect(pos.x, pos.y - static_cast<int>(std::ceil(font->FontSize)),
+        static_cast<int>(std::ceil(textLayout.size.x)), static_cast<int>(std::ceil(textLayout.size.y)));
+}
+
+cv::Rect CardText::rasterize(cv::Mat& image, cv::Point pos, const std::string& text, cv::Scalar color) {
+    CV_Assert(image.type() == CV_8UC4);
+    const Layout& textLayout = layout(text);
+    unsigned char* atlasPixels;
+    int atlasWidth, atlasHeight;
+    font->ContainerAtlas->GetTexDataAsAlpha8(&atlasPixels, &atlasWidth, &atlasHeight);
+
+    cv::Point origin(pos.x, pos.y - static_cast<int>(std::ceil(font->FontSize)));
+    cv::Rect imageRegion(0, 0, image.cols, image.rows);
+    for (const Glyph& glyph : textLayout.glyphs) {
+        cv::Point atlasPos(static_cast<int>(std::lround(glyph.uvMin.x * atlasWidth)), static_cast<int>(std::lround(glyph.uvMin.y * atlasHeight)));
+        cv::Size glyphSize(static_cast<int>(std::lround((glyph.uvMax.x - glyph.uvMin.x) * atlasWidth)),
+            static_cast<int>(std::lround((glyph.uvMax.y - glyph.uvMin.y) * atlasHeight)));
+        cv::Point glyphPos(origin.x + static_cast<int>(std::lround(glyph.min.x)), origin.y + static_cast<int>(std::lround(glyph.min.y)));
+        cv::Rect drawn = cv::Rect(glyphPos, glyphSize) & imageRegion;
+
+        for (int y = drawn.y; y < drawn.br().y; y++) {
+            const unsigned char* coverage = atlasPixels + (atlasPos.y + y - glyphPos.y) * atlasWidth + atlasPos.x - glyphPos.x;
+            unsigned char* pixel = image.ptr<unsigned char>(y) + drawn.x * 4;
+            for (int x = drawn.x; x < drawn.br().x; x++, pixel += 4) {
+                int alpha = coverage[x];
+                if (alpha == 0) continue;
+                for (int channel = 0; channel < 3; channel++) {
+                    pixel[channel] = static_cast<unsigned char>((color[channel] * alpha + pixel[channel] * (255 - alpha) + 127) / 255);
+                }
+                pixel[3] = static_cast<unsigned char>(alpha + pixel[3] * (255 - alpha) / 255);
+            }
+        }
+    }
+    return region(pos, text) & imageRegion;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+// images on the system clipboard. the backend hands over the clipboard's image as an encoded PNG or BMP,
+// which is decoded straight into an RGBA cv::Mat and cached until the clipboard changes, so asking for the
+// image again (every paste, or every frame) costs nothing while the clipboard holds the same image.
+// on Linux the X11 backend asks the CLIPBOARD selection's owner for image/png (then image/bmp) and learns of
+// new owners through XFixes, on Windows the backend reads the PNG clipboard format or CF_DIB
+//
+// only used from the ui thread
+class Clipboard {
+public:
+	virtual ~Clipboard() = default;
+
+	// the backend for this platform, or nullptr if the clipboard can not be read
+	static std::unique_ptr<Clipboard> create();
+
+	// the clipboard's image as RGBA, or an empty Mat if it holds none. the returned Mat shares the cached pixels
+	cv::Mat image();
+	// changes whenever image() starts returning a different image
+	uint64_t imageVersion() const { return version; }
+
+	// the app's own native window. on X11 it only answers clipboard requests while the ui loop polls events,
+	// so a clipboard it owns (text copied from a text field) is taken to hold no image instead of being asked
+	void setOwnWindow(unsigned long nativeWindow) { ownWindow = nativeWindow; }
+
+protected:
+	// whether the clipboard may have changed since the last call, the first call returns true
+	virtual bool changed() = 0;
+	// the clipboard's image encoded as PNG or BMP, false if it holds no image
+	virtual bool readEncodedImage(std::vector<unsigned char>& encoded) = 0;
+
+	unsigned long ownWindow = 0;
+
+private:
+	cv::Mat cachedImage;
+	uint64_t version = 0;
+};
@@ -0,0 +1,237 @@
+#include "Clipboard.hpp"
+
+#include <climits>
+#include <iostream>
+
+#include <opencv2/imgcodecs.hpp>
+
+#include <PixelSwizzle.hpp>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <poll.h>
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/extensions/Xfixes.h>
+#endif
+
+cv::Mat Clipboard::image() {
+    if (changed()) {
+        //the old image may still be shared with a paste preview, so it is released rather than decoded over
+        cachedImage.release();
+        std::vector<unsigned char> encoded;
+        if (readEncodedImage(encoded)) {
+            cv::Mat decoded;
+            cv::imdecode(encoded, cv::IMREAD_COLOR, &decoded);
+            if (!decoded.empty()) {
+                PixelSwizzle::bgrToRgba(decoded, cachedImage);
+            }
+            else {
+                std::cerr << "Error decoding the clipboard image" << std::endl;
+            }
+        }
+        version++;
+    }
+    return cachedImage;
+}
+
+namespace {
+#if defined(_WIN32)
+    class Win32Clipboard : public Clipboard {
+    protected:
+        bool changed() override {
+            DWORD currentSequenceNumber = GetClipboardSequenceNumber();
+            if (read && currentSequenceNumber == sequenceNumber) return false;
+            read = true;
+            sequenceNumber = currentSequenceNumber;
+            return true;
+        }
+
+        bool readEncodedImage(std::vector<unsigned char>& encoded) override {
+            if (!OpenClipboard(nullptr)) return false;
+            bool found = copyClipboardData(RegisterClipboardFormatA("PNG"), encoded);
+            std::vector<unsigned char> dib;
+            if (!found && copyClipboardData(CF_DIB, dib) && dib.size() >= sizeof(BITMAPINFOHEADER)) {
+                //a DIB is a BMP file without its file header, which points past the masks and color table to the pixels
+                const BITMAPINFOHEADER* infoHeader = reinterpret_cast<const BITMAPINFOHEADER*>(dib.data());
+                size_t colorCount = infoHeader->biClrUsed != 0 ? infoHeader->biClrUsed :
+                    (infoHeader->biBitCount <= 8 ? (size_t(1) << infoHeader->biBitCount) : 0);
+                size_t masksSize = infoHeader->biSize == sizeof(BITMAPINFOHEADER) && infoHeader->biCompression == BI_BITFIELDS ? 3 * sizeof(DWORD) : 0;
+                BITMAPFILEHEADER fileHeader = {};
+                fileHeader.bfType = 0x4D42;
+                fileHeader.bfSize = static_cast<DWORD>(sizeof(fileHeader) + dib.size());
+                fileHeader.bfOffBits = static_cast<DWORD>(sizeof(fileHeader) + infoHeader->biSize + masksSize + colorCount * sizeof(RGBQUAD));
+                const unsigned char* fileHeaderBytes = reinterpret_cast<const unsigned char*>(&fileHeader);
+                encoded.assign(fileHeaderBytes, fileHeaderBytes + sizeof(fileHeader));
+                encoded.insert(encoded.end(), dib.begin(), dib.end());
+                found = true;
+            }
+            CloseClipboard();
+            return found;
+        }
+
+    private:
+        bool copyClipboardData(UINT format, std::vector<unsigned char>& data) {
+            if (format == 0 || !IsClipboardFormatAvailable(format)) return false;
+            HANDLE handle = GetClipboardData(format);
+            if (handle == nullptr) return false;
+            const unsigned char* bytes = static_cast<const unsigned char*>(GlobalLock(handle));
+            if (bytes == nullptr) return false;
+            data.assign(bytes, bytes + GlobalSize(handle));
+            GlobalUnlock(handle);
+            return true;
+        }
+
+        bool read = false;
+        DWORD sequenceNumber = 0;
+    };
+#elif defined(__linux__)
+    //an owner that does not answer within this long is given up on
+    const int selectionTimeoutMilliseconds = 1000;
+
+    class X11Clipboard : public Clipboard {
+    public:
+        ~X11Clipboard() override {
+            if (display == nullptr) return;
+            XDestroyWindow(display, window);
+            XCloseDisplay(display);
+        }
+
+        bool open() {
+            display = XOpenDisplay(nullptr);
+            if (display == nullptr) {
+                std::cerr << "Error opening the X display for the clipboard" << std::endl;
+                return false;
+            }
+            //selections are converted onto a property of a window of our own, which is never mapped
+            window = XCreateSimpleWindow(display, DefaultRootWindow(display), 0, 0, 1, 1, 0, 0, 0);
+            XSelectInput(display, window, PropertyChangeMask);
+            clipboardAtom = XInternAtom(display, "CLIPBOARD", False);
+            propertyAtom = XInternAtom(display, "FLASHCARDMAKER_CLIPBOARD", False);
+            incrAtom = XInternAtom(display, "INCR", False);
+            imageTargets[0] = XInternAtom(display, "image/png", False);
+            imageTargets[1] = XInternAtom(display, "image/bmp", False);
+
+            int errorBase = 0;
+            hasXFixes = XFixesQueryExtension(display, &xfixesEventBase, &errorBase) == True;
+            if (hasXFixes) {
+                XFixesSelectSelectionInput(display, window, clipboardAtom, XFixesSetSelectionOwnerNotifyMask);
+            }
+            return true;
+        }
+
+    protected:
+        bool changed() override {
+            bool ownerChanged = !read;
+            read = true;
+            if (hasXFixes) {
+                //every time a client takes the selection, even one that already owned it, XFixes sends a notify
+                XEvent event;
+                while (XCheckTypedWindowEvent(display, window, xfixesEventBase + XFixesSelectionNotify, &event)) {
+                    ownerChanged = true;
+                }
+            }
+            else {
+                Window currentOwner = XGetSelectionOwner(display, clipboardAtom);
+                if (currentOwner != owner) ownerChanged = true;
+                owner = currentOwner;
+            }
+            return ownerChanged;
+        }
+
+        bool readEncodedImage(std::vector<unsigned char>& encoded) override {
+            Window currentOwner = XGetSelectionOwner(display, clipboardAtom);
+            //asking our own window would block until the timeout, as nothing handles its requests while we wait
+            if (currentOwner == None || currentOwner == ownWindow) return false;
+            for (Atom target : imageTargets) {
+                if (convertSelection(target, encoded)) return true;
+            }
+            return false;
+        }
+
+    private:
+        bool waitForEvent(int type, XEvent& event) {
+            for (int waited = 0; waited < selectionTimeoutMilliseconds; waited += 10) {
+                if (XCheckTypedWindowEvent(display, window, type, &event)) return true;
+                pollfd connection = { ConnectionNumber(display), POLLIN, 0 };
+                poll(&connection, 1, 10);
+            }
+            return false;
+        }
+
+        //appends the property's value and deletes it, which tells an incremental transfer to send the next chunk
+        bool takeProperty(std::vector<unsigned char>& data, Atom& type) {
+            int format = 0;
+            unsigned long itemCount = 0;
+            unsigned long bytesLeft = 0;
+            unsigned char* value = nullptr;
+            if (XGetWindowProperty(display, window, propertyAtom, 0, LONG_MAX / 4, True, AnyPropertyType,
+                &type, &format, &itemCount, &bytesLeft, &value) != Success) {
+                return false;
+            }
+            if (value != nullptr) {
+                data.insert(data.end(), value, value + itemCount * (format / 8));
+                XFree(value);
+            }
+            return true;
+        }
+
+        bool convertSelection(Atom target, std::vector<unsigned char>& data) {
+            data.clear();
+            //property changes left over from earlier transfers are not part of this one
+            XEvent event;
+            while (XCheckTypedWindowEvent(display, window, PropertyNotify, &event)) {
+            }
+            XConvertSelection(display, clipboardAtom, target, propertyAtom, window, CurrentTime);
+            if (!waitForEvent(SelectionNotify, event)) {
+                std::cerr << "The clipboard owner did not answer" << std::endl;
+                return false;
+            }
+            if (event.xselection.property == None) return false;
+
+            Atom type = None;
+            if (!takeProperty(data, type)) return false;
+            if (type != incrAtom) return !data.empty();
+
+            //large images come in chunks, each one put into the property after the previous one was deleted,
+            //until an empty one ends the transfer
+            data.clear();
+            while (true) {
+                if (!waitForEvent(PropertyNotify, event)) {
+                    std::cerr << "The clipboard owner stopped sending the image" << std::endl;
+                    return false;
+                }
+                if (event.xproperty.atom != propertyAtom || event.xproperty.state != PropertyNewValue) continue;
+                size_t sizeBefore = data.size();
+                if (!takeProperty(data, type)) return false;
+                if (data.size() == sizeBefore) return !data.empty();
+            }
+        }
+
+        Display* display = nullptr;
+        Window window = 0;
+        Atom clipboardAtom = None;
+        Atom propertyAtom = None;
+        Atom incrAtom = None;
+        Atom imageTargets[2] = { None, None };
+        bool hasXFixes = false;
+        int xfixesEventBase = 0;
+        bool read = false;
+        Window owner = None;
+    };
+#endif
+}
+
+std::unique_ptr<Clipboard> Clipboard::create() {
+#if defined(_WIN32)
+    return std::make_unique<Win32Clipboard>();
+#elif defined(__linux__)
+    std::unique_ptr<X11Clipboard> clipboard = std::make_unique<X11Clipboard>();
+    if (!clipboard->open()) return nullptr;
+    return clipboard;
+#else
+    std::cerr << "Clipboard images are not supported on this platform" << std::endl;
+    return nullptr;
+#endif
+}
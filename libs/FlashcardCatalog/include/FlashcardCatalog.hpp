@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+
+// Background service that follows the topic folders under flashcardSavePath with inotify and keeps the
+// topics' keyword indexes (in memory and on disk) up to date, so searches of a watched topic never have to
+// look at the folder. Bursts of changes, e.g. a sync dropping thousands of cards at once, are coalesced and
+// applied as one index update per topic once the folder has been quiet for a moment. Topic packs being
+// written or removed are followed too, they only need the change callback as packs have no separate index.
+// flashcardSavePath is created by start() if it does not exist yet.
+//
+// Only available on Linux; start() returns false elsewhere and searches keep checking the folders themselves.
+class FlashcardCatalog {
+public:
+	explicit FlashcardCatalog(const std::string& flashcardSavePath);
+	~FlashcardCatalog();
+	FlashcardCatalog(const FlashcardCatalog&) = delete;
+	FlashcardCatalog& operator=(const FlashcardCatalog&) = delete;
+
+	bool start();
+	void stop();
+	bool isRunning() const { return running; }
+
+	// called from the catalog thread after a batch of changes has been applied
+	void setChangeCallback(std::function<void()> callback) { changeCallback = callback; }
+
+	// how long the folders have to be quiet before pending changes are applied, and the longest a change can wait
+	std::chrono::milliseconds quietPeriod{ 100 };
+	std::chrono::milliseconds maxDelay{ 1000 };
+
+private:
+	void watchLoop();
+	void watchTopic(const std::string& topic);
+	void unwatchTopic(int watchDescriptor);
+	void applyPendingChanges();
+
+	std::string flashcardSavePath;
+	std::function<void()> changeCallback;
+	std::thread watchThread;
+	std::atomic<bool> running{ false };
+	int inotifyFd = -1;
+	int stopFd = -1;
+	int rootWatch = -1;
+	std::map<int, std::string> watchedTopics;               // watch descriptor -> topic
+	std::map<std::string, std::set<std::string>> pendingChanges; // topic -> changed flashcard ids
+	std::set<std::string> pendingRescans;                    // topics whose events were lost
+	bool packsChanged = false;
+};
@@ -0,0 +1,252 @@
+#include "FlashcardCatalog.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <json.h>
+#include <FlashcardIndex.hpp>
+#include <WorkerPool.hpp>
+
+FlashcardCatalog::FlashcardCatalog(const std::string& flashcardSavePath)
+    : flashcardSavePath(flashcardSavePath) {
+}
+
+FlashcardCatalog::~FlashcardCatalog() {
+    stop();
+}
+
+#ifdef __linux__
+
+namespace {
+    const uint32_t topicWatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_DELETE_SELF | IN_ONLYDIR;
+    //topic folders come and go in the root, and so do the topics' packs
+    const uint32_t rootWatchMask = IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_ONLYDIR;
+}
+
+bool FlashcardCatalog::start() {
+    if (running) return true;
+
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    //on a fresh install the folder is only made by the first save, which would be too late to watch it
+    std::error_code ec;
+    std::filesystem::create_directories(flashcardSavePath, ec);
+    rootWatch = inotifyFd == -1 ? -1 : inotify_add_watch(inotifyFd, flashcardSavePath.c_str(), rootWatchMask);
+    if (inotifyFd == -1 || stopFd == -1 || rootWatch == -1) {
+        std::cerr << "Error starting flashcard catalog: could not watch " << flashcardSavePath << std::endl;
+        if (inotifyFd != -1) close(inotifyFd);
+        if (stopFd != -1) close(stopFd);
+        inotifyFd = stopFd = rootWatch = -1;
+        return false;
+    }
+
+    //watch first and warm the indexes afterwards so no card written in between is missed
+    for (const auto& dirEntry : std::filesystem::directory_iterator(flashcardSavePath, ec)) {
+        if (dirEntry.is_directory()) {
+            watchTopic(dirEntry.path().filename().string());
+        }
+    }
+
+    running = true;
+    watchThread = std::thread(&FlashcardCatalog::watchLoop, this);
+    return true;
+}
+
+void FlashcardCatalog::stop() {
+    if (!running) return;
+    uint64_t wake = 1;
+    if (write(stopFd, &wake, sizeof(wake)) != sizeof(wake)) {
+        std::cerr << "Error stopping flashcard catalog" << std::endl;
+    }
+    watchThread.join();
+    running = false;
+
+    for (const auto& watchedTopic : watchedTopics) {
+        FlashcardIndex::setTopicWatched(flashcardSavePath, watchedTopic.second, false);
+    }
+    watchedTopics.clear();
+    close(inotifyFd);
+    close(stopFd);
+    inotifyFd = stopFd = rootWatch = -1;
+}
+
+void FlashcardCatalog::watchTopic(const std::string& topic) {
+    int watchDescriptor = inotify_add_watch(inotifyFd, (flashcardSavePath + "/" + topic).c_str(), topicWatchMask);
+    if (watchDescriptor == -1) {
+        std::cerr << "Error watching flashcard topic: " << topic << std::endl;
+        return;
+    }
+    watchedTopics[watchDescriptor] = topic;
+    FlashcardIndex::setTopicWatched(flashcardSavePath, topic, true);
+    std::string directory = flashcardSavePath;
+    WorkerPool::shared().submit([directory, topic]() { FlashcardIndex::getTopicIndex(directory, topic); });
+}
+
+void FlashcardCatalog::unwatchTopic(int watchDescriptor) {
+    auto watchedTopic = watchedTopics.find(watchDescriptor);
+    if (watchedTopic == watchedTopics.end()) return;
+    FlashcardIndex::setTopicWatched(flashcardSavePath, watchedTopic->second, false);
+    pendingChanges.erase(watchedTopic->second);
+    watchedTopics.erase(watchedTopic);
+}
+
+void FlashcardCatalog::watchLoop() {
+    using clock = std::chrono::steady_clock;
+    clock::time_point firstPendingEvent;
+    clock::time_point lastPendingEvent;
+    std::vector<char> eventBuffer(64 * 1024);
+
+    while (true) {
+        bool pending = !pendingChanges.empty() || !pendingRescans.empty() || packsChanged;
+        int timeout = -1;
+        if (pending) {
+            clock::time_point applyAt = std::min(lastPendingEvent + quietPeriod, firstPendingEvent + maxDelay);
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(applyAt - clock::now()).count();
+            timeout = static_cast<int>(std::max<long long>(0, wait));
+        }
+
+        pollfd fds[2] = { { stopFd, POLLIN, 0 }, { inotifyFd, POLLIN, 0 } };
+        if (poll(fds, 2, timeout) == -1 && errno != EINTR) {
+            std::cerr << "Error in flashcard catalog: poll failed" << std::endl;
+            return;
+        }
+        if (fds[0].revents & POLLIN) return;
+
+        if (fds[1].revents & POLLIN) {
+            ssize_t length;
+            while ((length = read(inotifyFd, eventBuffer.data(), eventBuffer.size())) > 0) {
+                for (ssize_t offset = 0; offset < length;) {
+                    const inotify_event* event = reinterpret_cast<const inotify_event*>(eventBuffer.data() + offset);
+                    offset += sizeof(inotify_event) + event->len;
+                    std::string name = event->len > 0 ? std::string(event->name) : std::string();
+
+                    if (event->mask & IN_Q_OVERFLOW) {
+                        //events were dropped, so every topic has to be checked again
+                        for (const auto& watchedTopic : watchedTopics) {
+                            pendingRescans.insert(watchedTopic.second);
+                        }
+                    }
+                    else if (event->wd == rootWatch) {
+                        if (!(event->mask & IN_ISDIR)) {
+                            //packs are read straight from the file and remapped once it changes, the ui only has to search again
+                            if (std::filesystem::path(name).extension() == ".pack") packsChanged = true;
+                            continue;
+                        }
+                        if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                            watchTopic(name);
+                            pendingRescans.insert(name);
+                        }
+                        else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                            int topicWatch = -1;
+                            for (const auto& watchedTopic : watchedTopics) {
+                                if (watchedTopic.second == name) topicWatch = watchedTopic.first;
+                            }
+                            if (topicWatch != -1) {
+                                inotify_rm_watch(inotifyFd, topicWatch);
+                                unwatchTopic(topicWatch);
+                            }
+                        }
+                    }
+                    else if (event->mask & (IN_DELETE_SELF | IN_IGNORED)) {
+                        unwatchTopic(event->wd);
+                    }
+                    else {
+                        auto watchedTopic = watchedTopics.find(event->wd);
+                        std::filesystem::path cardPath(name);
+                        if (watchedTopic != watchedTopics.end() && cardPath.extension() == ".json") {
+                            pendingChanges[watchedTopic->second].insert(cardPath.stem().string());
+                        }
+                    }
+                }
+            }
+
+            clock::time_point now = clock::now();
+            if (!pending) firstPendingEvent = now;
+            lastPendingEvent = now;
+        }
+
+        pending = !pendingChanges.empty() || !pendingRescans.empty() || packsChanged;
+        clock::time_point now = clock::now();
+        if (pending && (now - lastPendingEvent >= quietPeriod || now - firstPendingEvent >= maxDelay)) {
+            applyPendingChanges();
+        }
+    }
+}
+
+void FlashcardCatalog::applyPendingChanges() {
+    for (const std::string& topic : pendingRescans) {
+        FlashcardIndex::invalidateTopicIndex(flashcardSavePath, topic);
+        pendingChanges.erase(topic);
+    }
+    pendingRescans.clear();
+
+    for (const auto& topicChanges : pendingChanges) {
+        const std::string& topic = topicChanges.first;
+        std::vector<std::string> flashcardIds(topicChanges.second.begin(), topicChanges.second.end());
+        std::vector<std::vector<std::string>> flashcardKeywords(flashcardIds.size());
+        std::vector<char> flashcardExists(flashcardIds.size(), 0);
+
+        //a sync can change thousands of cards at once, so parse them on the pool
+        WorkerPool::shared().parallelFor(flashcardIds.size(), [&](size_t i) {
+            std::ifstream ifs(flashcardSavePath + "/" + topic + "/" + flashcardIds[i] + ".json");
+            if (!ifs.is_open()) return;
+            Json::Value root;
+            Json::CharReaderBuilder builder;
+            builder["collectComments"] = false;
+            JSONCPP_STRING errs;
+            if (!parseFromStream(builder, ifs, &root, &errs)) return;
+            for (auto keyword : root["keywords"]) {
+                flashcardKeywords[i].push_back(keyword.asString());
+            }
+            flashcardExists[i] = 1;
+        });
+
+        std::map<std::string, std::vector<std::string>> addedFlashcards;
+        std::vector<std::string> removedFlashcards;
+        for (size_t i = 0; i < flashcardIds.size(); i++) {
+            if (flashcardExists[i]) addedFlashcards[flashcardIds[i]] = flashcardKeywords[i];
+            else removedFlashcards.push_back(flashcardIds[i]);
+        }
+        FlashcardIndex::updateFlashcards(flashcardSavePath, topic, addedFlashcards, removedFlashcards);
+    }
+    pendingChanges.clear();
+    packsChanged = false;
+
+    if (changeCallback) {
+        changeCallback();
+    }
+}
+
+#else
+
+bool FlashcardCatalog::start() {
+    return false;
+}
+
+void FlashcardCatalog::stop() {
+}
+
+void FlashcardCatalog::watchLoop() {
+}
+
+void FlashcardCatalog::watchTopic(const std::string& topic) {
+}
+
+void FlashcardCatalog::unwatchTopic(int watchDescriptor) {
+}
+
+void FlashcardCatalog::applyPendingChanges() {
+}
+
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <opencv2/core.hpp>
+
+// decoded flashcard images shared by everything that shows cards, so a deck that is reviewed again is not
+// read and decoded again. entries are keyed by the file the image came from together with that file's mtime
+// and size, so a rewritten file misses instead of returning stale pixels. the least recently used images are
+// dropped once the decoded pixels go over the byte budget
+//
+// images returned from the cache share their pixels with it and must be treated as read only. every decoded image
+// gets a version number that no other image has, so views can tell whether they already show these exact pixels
+class FlashcardImageCache {
+public:
+	struct Stats {
+		uint64_t hits;
+		uint64_t misses;
+		size_t entries;
+		size_t bytes;
+		size_t byteBudget;
+	};
+
+	explicit FlashcardImageCache(size_t byteBudget = 256 * 1024 * 1024);
+	FlashcardImageCache(const FlashcardImageCache&) = delete;
+	FlashcardImageCache& operator=(const FlashcardImageCache&) = delete;
+
+	static FlashcardImageCache& shared();
+
+	// the cached image for key if the file still has this mtime and size, an empty Mat otherwise
+	cv::Mat find(const std::string& key, long long writeTime, uint64_t fileSize, uint64_t* version = nullptr);
+	void insert(const std::string& key, long long writeTime, uint64_t fileSize, const cv::Mat& image, uint64_t version);
+
+	// a version number for a newly decoded image
+	static uint64_t newVersion();
+
+	void setByteBudget(size_t byteBudget);
+	void clear();
+	Stats stats();
+
+private:
+	struct Entry {
+		std::string key;
+		long long writeTime;
+		uint64_t fileSize;
+		cv::Mat image;
+		uint64_t version;
+	};
+
+	void evictOverBudget();
+
+	std::mutex mutex;
+	std::list<Entry> entries; // most recently used first
+	std::unordered_map<std::string, std::list<Entry>::iterator> entriesByKey;
+	size_t bytes = 0;
+	size_t byteBudget;
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+};
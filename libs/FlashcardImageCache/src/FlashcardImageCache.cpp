@@ -0,0 +1,85 @@
+#include "FlashcardImageCache.hpp"
+
+namespace {
+    size_t imageBytes(const cv::Mat& image) {
+        return image.total() * image.elemSize();
+    }
+}
+
+FlashcardImageCache::FlashcardImageCache(size_t byteBudget)
+    : byteBudget(byteBudget) {
+}
+
+FlashcardImageCache& FlashcardImageCache::shared() {
+    static FlashcardImageCache imageCache;
+    return imageCache;
+}
+
+uint64_t FlashcardImageCache::newVersion() {
+    static std::atomic<uint64_t> lastVersion{ 0 };
+    return ++lastVersion;
+}
+
+cv::Mat FlashcardImageCache::find(const std::string& key, long long writeTime, uint64_t fileSize, uint64_t* version) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto cached = entriesByKey.find(key);
+    if (cached == entriesByKey.end()) {
+        misses++;
+        return cv::Mat();
+    }
+    std::list<Entry>::iterator entry = cached->second;
+    if (entry->writeTime != writeTime || entry->fileSize != fileSize) {
+        //the file was rewritten since it was decoded
+        bytes -= imageBytes(entry->image);
+        entries.erase(entry);
+        entriesByKey.erase(cached);
+        misses++;
+        return cv::Mat();
+    }
+    entries.splice(entries.begin(), entries, entry);
+    hits++;
+    if (version) *version = entry->version;
+    return entry->image;
+}
+
+void FlashcardImageCache::insert(const std::string& key, long long writeTime, uint64_t fileSize, const cv::Mat& image, uint64_t version) {
+    if (image.empty()) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (imageBytes(image) > byteBudget) return;
+    auto cached = entriesByKey.find(key);
+    if (cached != entriesByKey.end()) {
+        bytes -= imageBytes(cached->second->image);
+        entries.erase(cached->second);
+        entriesByKey.erase(cached);
+    }
+    entries.push_front({ key, writeTime, fileSize, image, version });
+    entriesByKey[key] = entries.begin();
+    bytes += imageBytes(image);
+    evictOverBudget();
+}
+
+void FlashcardImageCache::setByteBudget(size_t byteBudget) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->byteBudget = byteBudget;
+    evictOverBudget();
+}
+
+void FlashcardImageCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    entriesByKey.clear();
+    bytes = 0;
+}
+
+FlashcardImageCache::Stats FlashcardImageCache::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return { hits, misses, entries.size(), bytes, byteBudget };
+}
+
+void FlashcardImageCache::evictOverBudget() {
+    while (bytes > byteBudget && !entries.empty()) {
+        bytes -= imageBytes(entries.back().image);
+        entriesByKey.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
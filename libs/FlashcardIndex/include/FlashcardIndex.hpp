@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace FlashcardIndex {
+	// inverted keyword index for the flashcards saved under one topic folder
+	struct TopicIndex {
+		std::string indexPath;
+		long long directoryWriteTime = 0;
+		std::vector<std::string> flashcardIds;                      // sorted
+		std::map<std::string, std::vector<std::string>> postings;  // keyword -> sorted flashcard ids
+	};
+
+	std::string indexPathForTopic(const std::string& directory, const std::string& topic);
+
+	// returns the index for directory/topic, loading it from disk or building it from the card files if it is missing or stale
+	// the index returned is an immutable snapshot that is safe to query from any thread
+	// concurrent callers share a single build; callers whose cancelled flag gets set stop waiting for it and get nullptr
+	std::shared_ptr<const TopicIndex> getTopicIndex(const std::string& directory, const std::string& topic, const std::atomic<bool>* cancelled = nullptr);
+	// parses the topic's card files in parallel on the shared worker pool
+	TopicIndex buildTopicIndex(const std::string& directory, const std::string& topic);
+	bool loadTopicIndex(const std::string& indexPath, TopicIndex& index);
+	bool saveTopicIndex(const TopicIndex& index);
+
+	// records a saved flashcard in the cached and on-disk index, replacing any keywords it had before
+	void addFlashcard(const std::string& directory, const std::string& topic, const std::string& flashcardId, const std::vector<std::string>& keywords);
+	// applies a batch of added/changed and removed flashcards with a single index rewrite
+	void updateFlashcards(const std::string& directory, const std::string& topic,
+		const std::map<std::string, std::vector<std::string>>& addedFlashcards, const std::vector<std::string>& removedFlashcards);
+
+	// a watched topic's folder is being followed by the catalog, so its cached index is trusted without checking the folder
+	void setTopicWatched(const std::string& directory, const std::string& topic, bool watched);
+	// forces the next getTopicIndex to reload or rebuild, e.g. after file change notifications were lost
+	void invalidateTopicIndex(const std::string& directory, const std::string& topic);
+
+	// ids of the flashcards that have all of the keywords (empty keywords are ignored)
+	std::vector<std::string> query(const TopicIndex& index, const std::vector<std::string>& keywords);
+	// the ids in flashcardIds (sorted) that also have all of the keywords, for narrowing an earlier query's results
+	std::vector<std::string> refine(const TopicIndex& index, const std::vector<std::string>& flashcardIds, const std::vector<std::string>& keywords);
+}
@@ -0,0 +1,357 @@
+#include "FlashcardIndex.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <json.h>
+#include <WorkerPool.hpp>
+
+namespace FlashcardIndex {
+    namespace {
+        struct CachedIndex {
+            std::shared_ptr<const TopicIndex> index;
+            std::shared_future<std::shared_ptr<const TopicIndex>> pendingBuild;
+            bool watched = false;
+        };
+        std::mutex cachedIndexesMutex;
+        std::map<std::string, CachedIndex> cachedIndexes;
+        //updates copy the current snapshot, so two at once would drop one of the changes
+        std::mutex indexUpdatesMutex;
+
+        long long directoryWriteTime(const std::string& directory) {
+            std::error_code ec;
+            auto writeTime = std::filesystem::last_write_time(directory, ec);
+            if (ec) return -1;
+            return static_cast<long long>(writeTime.time_since_epoch().count());
+        }
+
+        void insertSorted(std::vector<std::string>& ids, const std::string& id) {
+            auto it = std::lower_bound(ids.begin(), ids.end(), id);
+            if (it == ids.end() || *it != id) {
+                ids.insert(it, id);
+            }
+        }
+    }
+
+    std::string indexPathForTopic(const std::string& directory, const std::string& topic) {
+        //the index lives next to the topic folder so that writing it does not touch the folder's write time
+        return directory + "/" + topic + ".index";
+    }
+
+    TopicIndex buildTopicIndex(const std::string& directory, const std::string& topic) {
+        TopicIndex index;
+        index.indexPath = indexPathForTopic(directory, topic);
+        std::string flashcardDirectory = directory + "/" + topic;
+        index.directoryWriteTime = directoryWriteTime(flashcardDirectory);
+        if (index.directoryWriteTime == -1) {
+            return index;
+        }
+
+        std::vector<std::filesystem::path> flashcardPaths;
+        std::error_code ec;
+        for (const auto& dirEntry : std::filesystem::directory_iterator(flashcardDirectory, ec)) {
+            if (dirEntry.path().extension() == ".json") {
+                flashcardPaths.push_back(dirEntry.path());
+            }
+        }
+        //sorting the paths up front makes the merged index independent of the order the workers finish in
+        std::sort(flashcardPaths.begin(), flashcardPaths.end());
+
+        //each worker opens, parses and pulls the keywords out of its own cards
+        std::vector<std::vector<std::string>> flashcardKeywords(flashcardPaths.size());
+        std::vector<char> flashcardParsed(flashcardPaths.size(), 0);
+        WorkerPool::shared().parallelFor(flashcardPaths.size(), [&](size_t i) {
+            Json::CharReaderBuilder builder;
+            builder["collectComments"] = false;
+            Json::Value root;
+            std::ifstream ifs(flashcardPaths[i]);
+            JSONCPP_STRING errs;
+            if (!parseFromStream(builder, ifs, &root, &errs)) {
+                std::cerr << "Error indexing flashcard: " << flashcardPaths[i].string() << std::endl;
+                std::cerr << errs << std::endl;
+                return;
+            }
+            for (auto flashcardKeyword : root["keywords"]) {
+                flashcardKeywords[i].push_back(flashcardKeyword.asString());
+            }
+            flashcardParsed[i] = 1;
+        });
+
+        for (size_t i = 0; i < flashcardPaths.size(); i++) {
+            if (!flashcardParsed[i]) continue;
+            std::string flashcardId = flashcardPaths[i].stem().string();
+            index.flashcardIds.push_back(flashcardId);
+            for (const std::string& keyword : flashcardKeywords[i]) {
+                index.postings[keyword].push_back(flashcardId);
+            }
+        }
+
+        std::sort(index.flashcardIds.begin(), index.flashcardIds.end());
+        for (auto& posting : index.postings) {
+            std::sort(posting.second.begin(), posting.second.end());
+            posting.second.erase(std::unique(posting.second.begin(), posting.second.end()), posting.second.end());
+        }
+        return index;
+    }
+
+    bool loadTopicIndex(const std::string& indexPath, TopicIndex& index) {
+        std::ifstream ifs(indexPath);
+        if (!ifs.is_open()) return false;
+
+        Json::Value root;
+        Json::CharReaderBuilder builder;
+        builder["collectComments"] = false;
+        JSONCPP_STRING errs;
+        if (!parseFromStream(builder, ifs, &root, &errs)) {
+            std::cerr << "Error reading flashcard index: " << indexPath << std::endl;
+            std::cerr << errs << std::endl;
+            return false;
+        }
+
+        index = TopicIndex();
+        index.indexPath = indexPath;
+        index.directoryWriteTime = root["directoryWriteTime"].asInt64();
+        for (auto flashcardId : root["flashcards"]) {
+            index.flashcardIds.push_back(flashcardId.asString());
+        }
+        for (auto it = root["keywords"].begin(); it != root["keywords"].end(); it++) {
+            std::vector<std::string>& posting = index.postings[it.name()];
+            for (auto flashcardId : *it) {
+                posting.push_back(flashcardId.asString());
+            }
+        }
+        return true;
+    }
+
+    bool saveTopicIndex(const TopicIndex& index) {
+        Json::Value root;
+        root["directoryWriteTime"] = Json::Int64(index.directoryWriteTime);
+        root["flashcards"] = Json::arrayValue;
+        for (const std::string& flashcardId : index.flashcardIds) {
+            root["flashcards"].append(flashcardId);
+        }
+        root["keywords"] = Json::objectValue;
+        for (const auto& posting : index.postings) {
+            Json::Value& ids = root["keywords"][posting.first];
+            ids = Json::arrayValue;
+            for (const std::string& flashcardId : posting.second) {
+                ids.append(flashcardId);
+            }
+        }
+
+        //written to a temporary file that is swapped in, so a crash or a failed write never leaves a truncated index
+        //that the write time check would trust. the name is per thread as a build and an update can save at once
+        std::ostringstream temporaryPathStream;
+        temporaryPathStream << index.indexPath << "." << std::this_thread::get_id() << ".tmp";
+        std::string temporaryPath = temporaryPathStream.str();
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "";
+        std::string indexJson = Json::writeString(builder, root);
+        bool written = false;
+        {
+            std::ofstream indexFile(temporaryPath, std::ios::binary | std::ios::trunc);
+            written = indexFile.write(indexJson.data(), indexJson.size()).good();
+        }
+        std::error_code ec;
+        if (written) {
+            std::filesystem::rename(temporaryPath, index.indexPath, ec);
+        }
+        if (!written || ec) {
+            std::filesystem::remove(temporaryPath, ec);
+            std::cerr << "Error saving flashcard index: " << index.indexPath << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    std::shared_ptr<const TopicIndex> getTopicIndex(const std::string& directory, const std::string& topic, const std::atomic<bool>* cancelled) {
+        std::string indexPath = indexPathForTopic(directory, topic);
+        {
+            //a watched topic is kept up to date by the catalog, so its folder does not need checking
+            std::lock_guard<std::mutex> lock(cachedIndexesMutex);
+            auto cached = cachedIndexes.find(indexPath);
+            if (cached != cachedIndexes.end() && cached->second.watched && cached->second.index) {
+                return cached->second.index;
+            }
+        }
+        long long writeTime = directoryWriteTime(directory + "/" + topic);
+
+        std::promise<std::shared_ptr<const TopicIndex>> build;
+        std::shared_future<std::shared_ptr<const TopicIndex>> pendingBuild;
+        bool buildHere = false;
+        {
+            std::lock_guard<std::mutex> lock(cachedIndexesMutex);
+            CachedIndex& cached = cachedIndexes[indexPath];
+            if (cached.index && cached.index->directoryWriteTime == writeTime) {
+                return cached.index;
+            }
+            if (!cached.pendingBuild.valid()) {
+                cached.pendingBuild = build.get_future().share();
+                buildHere = true;
+            }
+            pendingBuild = cached.pendingBuild;
+        }
+
+        if (!buildHere) {
+            //another search is already loading or building this index, wait for it unless this search gets cancelled
+            while (pendingBuild.wait_for(std::chrono::milliseconds(5)) != std::future_status::ready) {
+                if (cancelled != nullptr && cancelled->load()) return nullptr;
+            }
+            return pendingBuild.get();
+        }
+
+        //the build is finished even if this search is cancelled, so the next search can use it
+        std::shared_ptr<TopicIndex> index = std::make_shared<TopicIndex>();
+        if (!loadTopicIndex(indexPath, *index) || index->directoryWriteTime != writeTime) {
+            //the index is missing or cards were added/removed since it was written
+            *index = buildTopicIndex(directory, topic);
+            if (index->directoryWriteTime != -1) {
+                saveTopicIndex(*index);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(cachedIndexesMutex);
+            CachedIndex& cached = cachedIndexes[indexPath];
+            cached.index = index;
+            cached.pendingBuild = std::shared_future<std::shared_ptr<const TopicIndex>>();
+        }
+        build.set_value(index);
+        if (cancelled != nullptr && cancelled->load()) return nullptr;
+        return index;
+    }
+
+    void addFlashcard(const std::string& directory, const std::string& topic, const std::string& flashcardId, const std::vector<std::string>& keywords) {
+        std::map<std::string, std::vector<std::string>> addedFlashcards;
+        addedFlashcards[flashcardId] = keywords;
+        updateFlashcards(directory, topic, addedFlashcards, std::vector<std::string>());
+    }
+
+    void updateFlashcards(const std::string& directory, const std::string& topic,
+        const std::map<std::string, std::vector<std::string>>& addedFlashcards, const std::vector<std::string>& removedFlashcards) {
+        std::lock_guard<std::mutex> updateLock(indexUpdatesMutex);
+        std::string indexPath = indexPathForTopic(directory, topic);
+        std::shared_ptr<TopicIndex> index;
+        {
+            std::lock_guard<std::mutex> lock(cachedIndexesMutex);
+            auto cached = cachedIndexes.find(indexPath);
+            if (cached != cachedIndexes.end() && cached->second.index) {
+                //searches may still be reading the current snapshot, so update a copy
+                index = std::make_shared<TopicIndex>(*cached->second.index);
+            }
+        }
+        if (!index) {
+            //building the index picks up the cards that were just written
+            getTopicIndex(directory, topic);
+            return;
+        }
+
+        std::vector<std::string> changedFlashcards = removedFlashcards;
+        for (const auto& addedFlashcard : addedFlashcards) {
+            changedFlashcards.push_back(addedFlashcard.first);
+        }
+        std::sort(changedFlashcards.begin(), changedFlashcards.end());
+        for (auto it = index->postings.begin(); it != index->postings.end();) {
+            std::vector<std::string>& posting = it->second;
+            posting.erase(std::remove_if(posting.begin(), posting.end(), [&](const std::string& flashcardId) {
+                return std::binary_search(changedFlashcards.begin(), changedFlashcards.end(), flashcardId);
+            }), posting.end());
+            if (posting.empty()) it = index->postings.erase(it);
+            else it++;
+        }
+        for (const std::string& flashcardId : removedFlashcards) {
+            auto it = std::lower_bound(index->flashcardIds.begin(), index->flashcardIds.end(), flashcardId);
+            if (it != index->flashcardIds.end() && *it == flashcardId) {
+                index->flashcardIds.erase(it);
+            }
+        }
+
+        for (const auto& addedFlashcard : addedFlashcards) {
+            insertSorted(index->flashcardIds, addedFlashcard.first);
+            for (const std::string& keyword : addedFlashcard.second) {
+                if (keyword.empty()) continue;
+                insertSorted(index->postings[keyword], addedFlashcard.first);
+            }
+        }
+        index->directoryWriteTime = directoryWriteTime(directory + "/" + topic);
+        saveTopicIndex(*index);
+
+        std::lock_guard<std::mutex> lock(cachedIndexesMutex);
+        cachedIndexes[indexPath].index = index;
+    }
+
+    void setTopicWatched(const std::string& directory, const std::string& topic, bool watched) {
+        std::lock_guard<std::mutex> lock(cachedIndexesMutex);
+        cachedIndexes[indexPathForTopic(directory, topic)].watched = watched;
+    }
+
+    void invalidateTopicIndex(const std::string& directory, const std::string& topic) {
+        std::lock_guard<std::mutex> lock(cachedIndexesMutex);
+        auto cached = cachedIndexes.find(indexPathForTopic(directory, topic));
+        if (cached != cachedIndexes.end()) {
+            cached->second.index.reset();
+        }
+    }
+
+    std::vector<std::string> query(const TopicIndex& index, const std::vector<std::string>& keywords) {
+        std::vector<const std::vector<std::string>*> postingLists;
+        for (const std::string& keyword : keywords) {
+            if (keyword.empty()) continue;
+            auto posting = index.postings.find(keyword);
+            if (posting == index.postings.end()) {
+                return std::vector<std::string>();
+            }
+            postingLists.push_back(&posting->second);
+        }
+        if (postingLists.empty()) {
+            return index.flashcardIds;
+        }
+
+        //intersect starting from the shortest posting list so the running result only shrinks
+        std::sort(postingLists.begin(), postingLists.end(),
+            [](const std::vector<std::string>* a, const std::vector<std::string>* b) { return a->size() < b->size(); });
+        std::vector<std::string> flashcardIds = *postingLists[0];
+        std::vector<std::string> intersection;
+        for (size_t i = 1; i < postingLists.size() && !flashcardIds.empty(); i++) {
+            intersection.clear();
+            std::set_intersection(flashcardIds.begin(), flashcardIds.end(),
+                postingLists[i]->begin(), postingLists[i]->end(), std::back_inserter(intersection));
+            flashcardIds.swap(intersection);
+        }
+        return flashcardIds;
+    }
+
+    std::vector<std::string> refine(const TopicIndex& index, const std::vector<std::string>& flashcardIds, const std::vector<std::string>& keywords) {
+        std::vector<const std::vector<std::string>*> postingLists;
+        for (const std::string& keyword : keywords) {
+            if (keyword.empty()) continue;
+            auto posting = index.postings.find(keyword);
+            if (posting == index.postings.end()) {
+                return std::vector<std::string>();
+            }
+            postingLists.push_back(&posting->second);
+        }
+        std::sort(postingLists.begin(), postingLists.end(),
+            [](const std::vector<std::string>* a, const std::vector<std::string>* b) { return a->size() < b->size(); });
+
+        //only keep ids the index knows about, the others came from the topic's pack
+        std::vector<std::string> refinedIds;
+        std::set_intersection(flashcardIds.begin(), flashcardIds.end(),
+            index.flashcardIds.begin(), index.flashcardIds.end(), std::back_inserter(refinedIds));
+        std::vector<std::string> intersection;
+        for (size_t i = 0; i < postingLists.size() && !refinedIds.empty(); i++) {
+            intersection.clear();
+            std::set_intersection(refinedIds.begin(), refinedIds.end(),
+                postingLists[i]->begin(), postingLists[i]->end(), std::back_inserter(intersection));
+            refinedIds.swap(intersection);
+        }
+        return refinedIds;
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Single file per topic deck format (flashcardSavePath/<topic>.pack)
+//
+//   PackHeader
+//   PackFlashcard[flashcardCount]   sorted by name
+//   PackString[keywordCount]        keywords of every flashcard, referenced by firstKeyword/keywordCount
+//   PackBox[boxCount]               answer and question boxes, referenced by first*Box/*BoxCount
+//   string table                    names and keywords, not null terminated
+//   image blobs                     the encoded card images exactly as they were saved
+//
+// Every section starts on an 8 byte boundary and all values are little endian, so the metadata can be
+// used straight from a read only mapping of the file.
+namespace FlashcardPack {
+	const char packMagic[4] = { 'F', 'C', 'P', 'K' };
+	const uint32_t packVersion = 1;
+
+	struct PackHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t flashcardCount;
+		uint32_t keywordCount;
+		uint32_t boxCount;
+		uint32_t reserved;
+		uint64_t flashcardTableOffset;
+		uint64_t keywordTableOffset;
+		uint64_t boxTableOffset;
+		uint64_t stringTableOffset;
+		uint64_t stringTableSize;
+		uint64_t blobOffset;
+	};
+
+	struct PackString {
+		uint32_t offset;
+		uint32_t length;
+	};
+
+	struct PackBox {
+		int32_t x0, y0, x1, y1;
+	};
+
+	struct PackFlashcard {
+		PackString name;
+		uint32_t firstKeyword;
+		uint32_t keywordCount;
+		uint32_t firstAnswerBox;
+		uint32_t answerBoxCount;
+		uint32_t firstQuestionBox;
+		uint32_t questionBoxCount;
+		uint64_t imageOffset;
+		uint64_t imageSize;
+	};
+
+	static_assert(sizeof(PackHeader) == 72, "PackHeader layout changed");
+	static_assert(sizeof(PackFlashcard) == 48, "PackFlashcard layout changed");
+
+	// read only memory mapping of a pack file, validated when it is opened. opening it also builds each keyword's
+	// posting list in memory, so queries intersect lists like the loose cards' keyword index instead of scanning every card
+	class MappedPack {
+	public:
+		MappedPack() = default;
+		~MappedPack();
+		MappedPack(const MappedPack&) = delete;
+		MappedPack& operator=(const MappedPack&) = delete;
+
+		bool open(const std::string& path);
+		void close();
+		bool isOpen() const { return data != nullptr; }
+
+		const PackHeader& header() const { return *reinterpret_cast<const PackHeader*>(data); }
+		uint32_t flashcardCount() const { return header().flashcardCount; }
+		const PackFlashcard& flashcard(uint32_t i) const;
+		const PackFlashcard* findFlashcard(std::string_view name) const;
+
+		std::string_view name(const PackFlashcard& flashcard) const { return string(flashcard.name); }
+		std::string_view keyword(const PackFlashcard& flashcard, uint32_t i) const;
+		const PackBox* answerBoxes(const PackFlashcard& flashcard) const;
+		const PackBox* questionBoxes(const PackFlashcard& flashcard) const;
+		const unsigned char* image(const PackFlashcard& flashcard) const { return data + flashcard.imageOffset; }
+		// numbers of the flashcards that have keyword, sorted, or nullptr if none has it
+		const std::vector<uint32_t>* posting(std::string_view keyword) const;
+
+	private:
+		bool validate() const;
+		void buildPostings();
+		std::string_view string(const PackString& str) const;
+
+		const unsigned char* data = nullptr;
+		size_t size = 0;
+		std::map<std::string_view, std::vector<uint32_t>> postings; // keywords point into the mapping
+#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#endif
+	};
+
+	std::string packPathForTopic(const std::string& directory, const std::string& topic);
+
+	// the mapped pack for directory/topic, or nullptr if the topic has not been packed
+	// the mapping stays valid for as long as the returned pointer is held, even if the pack is rewritten
+	std::shared_ptr<const MappedPack> getTopicPack(const std::string& directory, const std::string& topic);
+	void closeTopicPack(const std::string& directory, const std::string& topic);
+
+	// true if the packed flashcard has all of the keywords (empty keywords are ignored)
+	bool hasKeywords(const MappedPack& pack, const PackFlashcard& flashcard, const std::vector<std::string>& keywords);
+	// names of the packed flashcards that have all of the keywords (empty keywords are ignored), sorted
+	std::vector<std::string> query(const MappedPack& pack, const std::vector<std::string>& keywords);
+
+	// packs the loose .json/.png (or .qoi) flashcards of directory/topic (merged with an existing pack) into directory/<topic>.pack
+	// removeLooseFiles deletes the cards that were packed and the topic's keyword index afterwards
+	bool convertTopicToPack(const std::string& directory, const std::string& topic, bool removeLooseFiles);
+}
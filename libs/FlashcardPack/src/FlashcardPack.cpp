@@ -0,0 +1,487 @@
+#include "FlashcardPack.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <json.h>
+#include <FlashcardIndex.hpp>
+
+namespace FlashcardPack {
+    namespace {
+        struct OpenPack {
+            std::shared_ptr<const MappedPack> pack;
+            std::filesystem::file_time_type writeTime;
+        };
+        std::mutex openPacksMutex;
+        std::map<std::string, OpenPack> openPacks;
+
+        uint64_t alignTo8(uint64_t offset) {
+            return (offset + 7) & ~uint64_t(7);
+        }
+
+        // a flashcard waiting to be written, either from the loose files or from the existing pack
+        struct PendingFlashcard {
+            std::string name;
+            std::vector<std::string> keywords;
+            std::vector<PackBox> answerBoxes;
+            std::vector<PackBox> questionBoxes;
+            std::string imagePath;
+            const MappedPack* sourcePack = nullptr;
+            const PackFlashcard* sourceFlashcard = nullptr;
+            uint64_t imageSize = 0;
+        };
+
+        void readBoxes(const Json::Value& boxList, std::vector<PackBox>& boxes) {
+            for (auto jsonBoxBounds : boxList) {
+                PackBox box;
+                box.x0 = jsonBoxBounds[0][0].asInt();
+                box.y0 = jsonBoxBounds[0][1].asInt();
+                box.x1 = jsonBoxBounds[1][0].asInt();
+                box.y1 = jsonBoxBounds[1][1].asInt();
+                boxes.push_back(box);
+            }
+        }
+
+        void writePadding(std::ofstream& packFile, uint64_t& position, uint64_t alignedPosition) {
+            static const char zeros[8] = {};
+            packFile.write(zeros, alignedPosition - position);
+            position = alignedPosition;
+        }
+    }
+
+    MappedPack::~MappedPack() {
+        close();
+    }
+
+    bool MappedPack::open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(PackHeader)) {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL) {
+            CloseHandle(file);
+            return false;
+        }
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == NULL) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+        fileHandle = file;
+        mappingHandle = mapping;
+        data = static_cast<const unsigned char*>(view);
+        size = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1) return false;
+        struct stat sb;
+        if (fstat(fd, &sb) != 0 || sb.st_size < (off_t)sizeof(PackHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void* view = mmap(nullptr, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) return false;
+        data = static_cast<const unsigned char*>(view);
+        size = static_cast<size_t>(sb.st_size);
+#endif
+        if (!validate()) {
+            std::cerr << "Error opening flashcard pack: " << path << " is not a valid pack file." << std::endl;
+            close();
+            return false;
+        }
+        buildPostings();
+        return true;
+    }
+
+    void MappedPack::close() {
+        postings.clear();
+        if (data == nullptr) return;
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+#else
+        munmap(const_cast<unsigned char*>(data), size);
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    bool MappedPack::validate() const {
+        const PackHeader& h = header();
+        if (std::memcmp(h.magic, packMagic, sizeof(packMagic)) != 0 || h.version != packVersion) return false;
+
+        auto sectionFits = [&](uint64_t offset, uint64_t count, uint64_t elementSize) {
+            return offset % 8 == 0 && offset <= size && count <= (size - offset) / elementSize;
+        };
+        if (!sectionFits(h.flashcardTableOffset, h.flashcardCount, sizeof(PackFlashcard)) ||
+            !sectionFits(h.keywordTableOffset, h.keywordCount, sizeof(PackString)) ||
+            !sectionFits(h.boxTableOffset, h.boxCount, sizeof(PackBox)) ||
+            !sectionFits(h.stringTableOffset, h.stringTableSize, 1)) {
+            return false;
+        }
+
+        //check every reference once here so the accessors never have to
+        auto stringFits = [&](const PackString& str) {
+            return str.offset <= h.stringTableSize && str.length <= h.stringTableSize - str.offset;
+        };
+        const PackString* keywords = reinterpret_cast<const PackString*>(data + h.keywordTableOffset);
+        for (uint32_t i = 0; i < h.keywordCount; i++) {
+            if (!stringFits(keywords[i])) return false;
+        }
+        for (uint32_t i = 0; i < h.flashcardCount; i++) {
+            const PackFlashcard& f = flashcard(i);
+            if (!stringFits(f.name) ||
+                f.firstKeyword > h.keywordCount || f.keywordCount > h.keywordCount - f.firstKeyword ||
+                f.firstAnswerBox > h.boxCount || f.answerBoxCount > h.boxCount - f.firstAnswerBox ||
+                f.firstQuestionBox > h.boxCount || f.questionBoxCount > h.boxCount - f.firstQuestionBox ||
+                f.imageOffset < h.blobOffset || f.imageOffset > size || f.imageSize > size - f.imageOffset) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void MappedPack::buildPostings() {
+        //flashcards are visited in order, so every list comes out sorted
+        for (uint32_t i = 0; i < flashcardCount(); i++) {
+            const PackFlashcard& f = flashcard(i);
+            for (uint32_t k = 0; k < f.keywordCount; k++) {
+                std::vector<uint32_t>& posting = postings[keyword(f, k)];
+                if (posting.empty() || posting.back() != i) posting.push_back(i);
+            }
+        }
+    }
+
+    const std::vector<uint32_t>* MappedPack::posting(std::string_view keyword) const {
+        auto found = postings.find(keyword);
+        return found == postings.end() ? nullptr : &found->second;
+    }
+
+    const PackFlashcard& MappedPack::flashcard(uint32_t i) const {
+        return reinterpret_cast<const PackFlashcard*>(data + header().flashcardTableOffset)[i];
+    }
+
+    const PackFlashcard* MappedPack::findFlashcard(std::string_view name) const {
+        const PackFlashcard* first = &flashcard(0);
+        const PackFlashcard* last = first + flashcardCount();
+        const PackFlashcard* found = std::lower_bound(first, last, name,
+            [this](const PackFlashcard& f, std::string_view n) { return this->name(f) < n; });
+        if (found == last || this->name(*found) != name) return nullptr;
+        return found;
+    }
+
+    std::string_view MappedPack::string(const PackString& str) const {
+        return std::string_view(reinterpret_cast<const char*>(data + header().stringTableOffset + str.offset), str.length);
+    }
+
+    std::string_view MappedPack::keyword(const PackFlashcard& flashcard, uint32_t i) const {
+        const PackString* keywords = reinterpret_cast<const PackString*>(data + header().keywordTableOffset);
+        return string(keywords[flashcard.firstKeyword + i]);
+    }
+
+    const PackBox* MappedPack::answerBoxes(const PackFlashcard& flashcard) const {
+        return reinterpret_cast<const PackBox*>(data + header().boxTableOffset) + flashcard.firstAnswerBox;
+    }
+
+    const PackBox* MappedPack::questionBoxes(const PackFlashcard& flashcard) const {
+        return reinterpret_cast<const PackBox*>(data + header().boxTableOffset) + flashcard.firstQuestionBox;
+    }
+
+    std::string packPathForTopic(const std::string& directory, const std::string& topic) {
+        return directory + "/" + topic + ".pack";
+    }
+
+    std::shared_ptr<const MappedPack> getTopicPack(const std::string& directory, const std::string& topic) {
+        std::string packPath = packPathForTopic(directory, topic);
+        std::error_code ec;
+        auto writeTime = std::filesystem::last_write_time(packPath, ec);
+
+        std::lock_guard<std::mutex> lock(openPacksMutex);
+        if (ec) {
+            openPacks.erase(packPath);
+            return nullptr;
+        }
+
+        OpenPack& openPack = openPacks[packPath];
+        if (openPack.pack && openPack.writeTime == writeTime) {
+            return openPack.pack;
+        }
+        std::shared_ptr<MappedPack> pack = std::make_shared<MappedPack>();
+        if (!pack->open(packPath)) {
+            openPacks.erase(packPath);
+            return nullptr;
+        }
+        openPack.pack = pack;
+        openPack.writeTime = writeTime;
+        return openPack.pack;
+    }
+
+    void closeTopicPack(const std::string& directory, const std::string& topic) {
+        std::lock_guard<std::mutex> lock(openPacksMutex);
+        openPacks.erase(packPathForTopic(directory, topic));
+    }
+
+    bool hasKeywords(const MappedPack& pack, const PackFlashcard& flashcard, const std::vector<std::string>& keywords) {
+        for (const std::string& keyword : keywords) {
+            if (keyword.empty()) continue;
+            bool keywordFound = false;
+            for (uint32_t k = 0; k < flashcard.keywordCount && !keywordFound; k++) {
+                keywordFound = pack.keyword(flashcard, k) == keyword;
+            }
+            if (!keywordFound) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<std::string> query(const MappedPack& pack, const std::vector<std::string>& keywords) {
+        std::vector<const std::vector<uint32_t>*> postingLists;
+        for (const std::string& keyword : keywords) {
+            if (keyword.empty()) continue;
+            const std::vector<uint32_t>* posting = pack.posting(keyword);
+            if (posting == nullptr) {
+                return std::vector<std::string>();
+            }
+            postingLists.push_back(posting);
+        }
+
+        std::vector<std::string> flashcardNames;
+        if (postingLists.empty()) {
+            for (uint32_t i = 0; i < pack.flashcardCount(); i++) {
+                flashcardNames.push_back(std::string(pack.name(pack.flashcard(i))));
+            }
+            return flashcardNames;
+        }
+
+        //intersect starting from the shortest posting list so the running result only shrinks
+        std::sort(postingLists.begin(), postingLists.end(),
+            [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) { return a->size() < b->size(); });
+        std::vector<uint32_t> flashcardNumbers = *postingLists[0];
+        std::vector<uint32_t> intersection;
+        for (size_t i = 1; i < postingLists.size() && !flashcardNumbers.empty(); i++) {
+            intersection.clear();
+            std::set_intersection(flashcardNumbers.begin(), flashcardNumbers.end(),
+                postingLists[i]->begin(), postingLists[i]->end(), std::back_inserter(intersection));
+            flashcardNumbers.swap(intersection);
+        }
+
+        //the flashcard table is sorted by name, so the names come out sorted too
+        for (uint32_t i : flashcardNumbers) {
+            flashcardNames.push_back(std::string(pack.name(pack.flashcard(i))));
+        }
+        return flashcardNames;
+    }
+
+    bool convertTopicToPack(const std::string& directory, const std::string& topic, bool removeLooseFiles) {
+        std::string packPath = packPathForTopic(directory, topic);
+        std::string flashcardDirectory = directory + "/" + topic;
+        std::map<std::string, PendingFlashcard> pendingFlashcards;
+
+        //start from the cards that are already packed
+        std::shared_ptr<const MappedPack> existingPack = getTopicPack(directory, topic);
+        if (existingPack != nullptr) {
+            for (uint32_t i = 0; i < existingPack->flashcardCount(); i++) {
+                const PackFlashcard& flashcard = existingPack->flashcard(i);
+                PendingFlashcard pending;
+                pending.name = std::string(existingPack->name(flashcard));
+                for (uint32_t k = 0; k < flashcard.keywordCount; k++) {
+                    pending.keywords.push_back(std::string(existingPack->keyword(flashcard, k)));
+                }
+                pending.answerBoxes.assign(existingPack->answerBoxes(flashcard), existingPack->answerBoxes(flashcard) + flashcard.answerBoxCount);
+                pending.questionBoxes.assign(existingPack->questionBoxes(flashcard), existingPack->questionBoxes(flashcard) + flashcard.questionBoxCount);
+                pending.sourcePack = existingPack.get();
+                pending.sourceFlashcard = &flashcard;
+                pending.imageSize = flashcard.imageSize;
+                pendingFlashcards[pending.name] = pending;
+            }
+        }
+
+        //loose cards replace packed cards with the same name
+        std::vector<std::filesystem::path> packedLooseFiles;
+        std::error_code ec;
+        if (std::filesystem::is_directory(flashcardDirectory, ec)) {
+            Json::CharReaderBuilder builder;
+            builder["collectComments"] = false;
+            for (const auto& dirEntry : std::filesystem::directory_iterator(flashcardDirectory)) {
+                if (dirEntry.path().extension() != ".json") continue;
+                std::filesystem::path imagePath = dirEntry.path();
+                imagePath.replace_extension(".qoi");
+                if (!std::filesystem::exists(imagePath, ec)) imagePath.replace_extension(".png");
+                uint64_t imageSize = std::filesystem::file_size(imagePath, ec);
+                if (ec) {
+                    std::cerr << "Error packing flashcard: " << imagePath.string() << " not found." << std::endl;
+                    continue;
+                }
+
+                Json::Value root;
+                std::ifstream ifs(dirEntry.path());
+                JSONCPP_STRING errs;
+                if (!parseFromStream(builder, ifs, &root, &errs)) {
+                    std::cerr << "Error packing flashcard: " << dirEntry.path().string() << std::endl;
+                    std::cerr << errs << std::endl;
+                    continue;
+                }
+
+                PendingFlashcard pending;
+                pending.name = dirEntry.path().stem().string();
+                for (auto keyword : root["keywords"]) {
+                    pending.keywords.push_back(keyword.asString());
+                }
+                readBoxes(root["answerBoxPositionsList"], pending.answerBoxes);
+                readBoxes(root["questionBoxPositionsList"], pending.questionBoxes);
+                pending.imagePath = imagePath.string();
+                pending.imageSize = imageSize;
+                pendingFlashcards[pending.name] = pending;
+                packedLooseFiles.push_back(dirEntry.path());
+                packedLooseFiles.push_back(imagePath);
+            }
+        }
+        if (pendingFlashcards.empty()) {
+            std::cerr << "Error packing flashcards: topic " << topic << " has no flashcards." << std::endl;
+            return false;
+        }
+
+        //lay out the metadata tables
+        PackHeader header = {};
+        std::memcpy(header.magic, packMagic, sizeof(packMagic));
+        header.version = packVersion;
+        std::vector<PackFlashcard> flashcardTable;
+        std::vector<PackString> keywordTable;
+        std::vector<PackBox> boxTable;
+        std::string stringTable;
+        auto addString = [&](const std::string& str) {
+            PackString packString = { static_cast<uint32_t>(stringTable.size()), static_cast<uint32_t>(str.size()) };
+            stringTable += str;
+            return packString;
+        };
+        for (const auto& entry : pendingFlashcards) {
+            const PendingFlashcard& pending = entry.second;
+            PackFlashcard flashcard = {};
+            flashcard.name = addString(pending.name);
+            flashcard.firstKeyword = static_cast<uint32_t>(keywordTable.size());
+            flashcard.keywordCount = static_cast<uint32_t>(pending.keywords.size());
+            for (const std::string& keyword : pending.keywords) keywordTable.push_back(addString(keyword));
+            flashcard.firstAnswerBox = static_cast<uint32_t>(boxTable.size());
+            flashcard.answerBoxCount = static_cast<uint32_t>(pending.answerBoxes.size());
+            boxTable.insert(boxTable.end(), pending.answerBoxes.begin(), pending.answerBoxes.end());
+            flashcard.firstQuestionBox = static_cast<uint32_t>(boxTable.size());
+            flashcard.questionBoxCount = static_cast<uint32_t>(pending.questionBoxes.size());
+            boxTable.insert(boxTable.end(), pending.questionBoxes.begin(), pending.questionBoxes.end());
+            flashcard.imageSize = pending.imageSize;
+            flashcardTable.push_back(flashcard);
+        }
+        header.flashcardCount = static_cast<uint32_t>(flashcardTable.size());
+        header.keywordCount = static_cast<uint32_t>(keywordTable.size());
+        header.boxCount = static_cast<uint32_t>(boxTable.size());
+        header.flashcardTableOffset = alignTo8(sizeof(PackHeader));
+        header.keywordTableOffset = alignTo8(header.flashcardTableOffset + flashcardTable.size() * sizeof(PackFlashcard));
+        header.boxTableOffset = alignTo8(header.keywordTableOffset + keywordTable.size() * sizeof(PackString));
+        header.stringTableOffset = alignTo8(header.boxTableOffset + boxTable.size() * sizeof(PackBox));
+        header.stringTableSize = stringTable.size();
+        header.blobOffset = alignTo8(header.stringTableOffset + stringTable.size());
+        uint64_t imageOffset = header.blobOffset;
+        for (PackFlashcard& flashcard : flashcardTable) {
+            flashcard.imageOffset = imageOffset;
+            imageOffset = alignTo8(imageOffset + flashcard.imageSize);
+        }
+
+        //write to a temporary file and swap it in so a failed conversion leaves the old deck alone
+        std::string temporaryPackPath = packPath + ".tmp";
+        {
+            std::ofstream packFile(temporaryPackPath, std::ios::binary | std::ios::trunc);
+            if (!packFile.is_open()) {
+                std::cerr << "Error packing flashcards: could not create " << temporaryPackPath << std::endl;
+                return false;
+            }
+            uint64_t position = 0;
+            packFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            position += sizeof(header);
+            writePadding(packFile, position, header.flashcardTableOffset);
+            packFile.write(reinterpret_cast<const char*>(flashcardTable.data()), flashcardTable.size() * sizeof(PackFlashcard));
+            position += flashcardTable.size() * sizeof(PackFlashcard);
+            writePadding(packFile, position, header.keywordTableOffset);
+            packFile.write(reinterpret_cast<const char*>(keywordTable.data()), keywordTable.size() * sizeof(PackString));
+            position += keywordTable.size() * sizeof(PackString);
+            writePadding(packFile, position, header.boxTableOffset);
+            packFile.write(reinterpret_cast<const char*>(boxTable.data()), boxTable.size() * sizeof(PackBox));
+            position += boxTable.size() * sizeof(PackBox);
+            writePadding(packFile, position, header.stringTableOffset);
+            packFile.write(stringTable.data(), stringTable.size());
+            position += stringTable.size();
+
+            std::vector<char> imageBuffer;
+            size_t i = 0;
+            for (const auto& entry : pendingFlashcards) {
+                const PendingFlashcard& pending = entry.second;
+                writePadding(packFile, position, flashcardTable[i++].imageOffset);
+                if (pending.sourcePack != nullptr) {
+                    packFile.write(reinterpret_cast<const char*>(pending.sourcePack->image(*pending.sourceFlashcard)), pending.imageSize);
+                }
+                else {
+                    imageBuffer.resize(pending.imageSize);
+                    std::ifstream imageFile(pending.imagePath, std::ios::binary);
+                    if (!imageFile.read(imageBuffer.data(), imageBuffer.size())) {
+                        std::cerr << "Error packing flashcards: could not read " << pending.imagePath << std::endl;
+                        packFile.close();
+                        std::filesystem::remove(temporaryPackPath, ec);
+                        return false;
+                    }
+                    packFile.write(imageBuffer.data(), imageBuffer.size());
+                }
+                position += pending.imageSize;
+            }
+            if (!packFile.good()) {
+                std::cerr << "Error packing flashcards: could not write " << temporaryPackPath << std::endl;
+                packFile.close();
+                std::filesystem::remove(temporaryPackPath, ec);
+                return false;
+            }
+        }
+
+        //the old mapping has to be gone before the file can be replaced on windows
+        pendingFlashcards.clear();
+        existingPack.reset();
+        closeTopicPack(directory, topic);
+        std::filesystem::rename(temporaryPackPath, packPath, ec);
+        if (ec) {
+            std::cerr << "Error packing flashcards: " << ec.message() << std::endl;
+            return false;
+        }
+
+        if (removeLooseFiles) {
+            for (const std::filesystem::path& looseFile : packedLooseFiles) {
+                std::filesystem::remove(looseFile, ec);
+            }
+            std::filesystem::remove(FlashcardIndex::indexPathForTopic(directory, topic), ec);
+        }
+        return true;
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include <FlashcardStore.hpp>
+
+// a flashcard decoded and ready to present
+struct PresentedFlashcard {
+	std::string topic;
+	std::string fileName;
+	cv::Mat image;
+	uint64_t imageVersion = 0;
+	std::vector<std::pair<cv::Point, cv::Point>> answerBoxBounds;
+	std::vector<std::pair<cv::Point, cv::Point>> questionBoxBounds;
+};
+
+// picks the presenter's upcoming cards ahead of time and loads them on the worker pool,
+// so moving to the next card only takes a card that has already been decoded
+class FlashcardPrefetcher {
+public:
+	explicit FlashcardPrefetcher(size_t depth);
+
+	// starts over with a new set of cards to pick from, dropping whatever was prefetched
+	void reset(const std::string& flashcardSavePath, std::shared_ptr<const std::vector<FlashcardStore::FlashcardRef>> flashcards);
+
+	// moves the next card into flashcard if it has finished loading, returns false while it is still loading.
+	// cards whose image could not be loaded are dropped and another card is loaded in their place, until as many
+	// cards in a row as there are to pick from have failed
+	bool takeNext(PresentedFlashcard& flashcard);
+	// true once prefetching gave up because none of the cards loaded, until the next reset()
+	bool noLoadableCards() const { return gaveUp; }
+
+private:
+	void fill();
+
+	size_t depth;
+	size_t failuresInRow = 0;
+	bool gaveUp = false;
+	std::string flashcardSavePath;
+	std::shared_ptr<const std::vector<FlashcardStore::FlashcardRef>> flashcards;
+	std::deque<std::future<PresentedFlashcard>> upcoming;
+	std::minstd_rand rng;
+};
@@ -0,0 +1,58 @@
+#include "FlashcardPrefetcher.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include <WorkerPool.hpp>
+
+FlashcardPrefetcher::FlashcardPrefetcher(size_t depth)
+    : depth(std::max<size_t>(depth, 1)), rng(std::random_device()()) {
+}
+
+void FlashcardPrefetcher::reset(const std::string& flashcardSavePath, std::shared_ptr<const std::vector<FlashcardStore::FlashcardRef>> flashcards) {
+    this->flashcardSavePath = flashcardSavePath;
+    this->flashcards = flashcards;
+    failuresInRow = 0;
+    gaveUp = false;
+    //loads still running finish in the background and are thrown away
+    upcoming.clear();
+    fill();
+}
+
+bool FlashcardPrefetcher::takeNext(PresentedFlashcard& flashcard) {
+    if (upcoming.empty() || upcoming.front().wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return false;
+    }
+    PresentedFlashcard next = upcoming.front().get();
+    upcoming.pop_front();
+    //a card whose image could not be read, or was not written yet by a save in progress, is skipped. once a
+    //whole result set's worth of cards failed in a row no more are loaded, so the ui can go idle
+    if (next.image.empty()) {
+        failuresInRow++;
+        if (failuresInRow >= flashcards->size()) gaveUp = true;
+        fill();
+        return false;
+    }
+    failuresInRow = 0;
+    fill();
+    flashcard = std::move(next);
+    return true;
+}
+
+void FlashcardPrefetcher::fill() {
+    if (!flashcards || flashcards->empty() || gaveUp) return;
+    std::uniform_int_distribution<size_t> pick(0, flashcards->size() - 1);
+    while (upcoming.size() < depth) {
+        std::string directory = flashcardSavePath;
+        FlashcardStore::FlashcardRef flashcardRef = (*flashcards)[pick(rng)];
+        upcoming.push_back(WorkerPool::shared().submit([directory, flashcardRef]() {
+            PresentedFlashcard flashcard;
+            flashcard.topic = flashcardRef.topic;
+            flashcard.fileName = flashcardRef.fileName;
+            flashcard.image = FlashcardStore::loadFlashcardImage(directory, flashcardRef.topic, flashcardRef.fileName, &flashcard.imageVersion);
+            FlashcardStore::loadFlashcardBoxBounds(directory, flashcardRef.topic, flashcardRef.fileName,
+                flashcard.answerBoxBounds, flashcard.questionBoxBounds);
+            return flashcard;
+        }));
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace FlashcardStore {
+	//make a file name for saving the flashcard
+	void makeFileName(char* fileName);
+
+	// a flashcard found by a search, with the topic it has to be loaded from
+	struct FlashcardRef {
+		std::string topic;
+		std::string fileName;
+	};
+
+	// a topic's cards can be packed, loose or both. a card that is both (saved again after its topic was packed) is
+	// found by its loose keywords and loaded from its loose files everywhere below, the packed copy is stale
+
+	// names of the topic folders and packs in directory, sorted
+	std::vector<std::string> getAllTopics(const std::string& directory);
+	// safe to call from any thread; returns early with no results once cancelled is set
+	std::vector<std::string> searchForFlashcards(std::string directory, std::string topic, std::vector<std::string> keywords, const std::atomic<bool>* cancelled = nullptr);
+	// searches every topic in topics at once (all topics if it is empty), results are grouped by topic in the order given
+	std::vector<FlashcardRef> searchForFlashcards(const std::string& directory, const std::vector<std::string>& topics,
+		const std::vector<std::string>& keywords, const std::atomic<bool>* cancelled = nullptr);
+	// keeps the flashcards from an earlier search that also have all of keywords, in the same order
+	// adding keywords to a query can only shrink its results, so this gives the same results as searching again
+	std::vector<FlashcardRef> refineSearch(const std::string& directory, const std::vector<FlashcardRef>& flashcards,
+		const std::vector<std::string>& keywords, const std::atomic<bool>* cancelled = nullptr);
+	// splits a comma separated topics filter into topic names, lowercased and trimmed like the saved topics
+	std::vector<std::string> parseTopics(const std::string& topicsFilter);
+	// splits a comma separated keywords filter into keywords, lowercased, trimmed, sorted and without duplicates
+	std::vector<std::string> parseKeywords(const std::string& keywordsFilter);
+	// RGBA image of the flashcard, served from FlashcardImageCache when it was decoded before; treat it as read only
+	// imageVersion is set to the decoded image's FlashcardImageCache version
+	cv::Mat loadFlashcardImage(std::string flashcardSavePath, std::string topic, std::string fileName, uint64_t* imageVersion = nullptr);
+	void loadFlashcardBoxBounds(std::string flashcardSavePath, std::string topic, std::string fileName,
+		std::vector<std::pair<cv::Point, cv::Point>>& answerBoxBounds,
+		std::vector<std::pair<cv::Point, cv::Point>>& questionBoxBounds);
+
+	// how card images are stored: PNG is smallest and opens anywhere, QOI encodes and decodes several times faster
+	enum class ImageFormat { Png, Qoi };
+	// the format named by the flashcardImageFormat config value ("png" or "qoi"), PNG for anything else
+	ImageFormat imageFormatFromName(const std::string& name);
+	// the card's loose image file, flashcardSavePath/topic/fileName.qoi or .png, whichever exists (the .png path if neither)
+	std::string flashcardImagePath(const std::string& flashcardSavePath, const std::string& topic, const std::string& fileName);
+	// writes the image of every flashcard in flashcardSavePath/topic, loose or packed and in either format, to
+	// exportPath/topic/fileName.png so it can be opened outside the app. returns how many were written
+	size_t exportTopicAsPng(const std::string& flashcardSavePath, const std::string& topic, const std::string& exportPath);
+
+	// writes flashcardSavePath/topic/fileName.json and .png or .qoi (creating the topic folder) and updates the topic's keyword index
+	// image is RGBA as shown in the editor and is only read, so a save can run on a snapshot that shares its pixels
+	bool saveFlashcard(std::string flashcardSavePath, std::string topic, std::string fileName,
+		const std::vector<std::string>& keywords,
+		const std::vector<std::pair<cv::Point, cv::Point>>& answerBoxBounds,
+		const std::vector<std::pair<cv::Point, cv::Point>>& questionBoxBounds,
+		const cv::Mat& image, ImageFormat imageFormat = ImageFormat::Png);
+
+	// runs saves on the shared worker pool so the editor never waits on encoding or disk writes
+	// saves of different cards run concurrently, saves of the same card one after another: a save enqueued while
+	// that card is still being saved waits for it, replacing any older save still waiting, so the newest snapshot
+	// is written last. the ui collects the outcomes with takeFinished()
+	class SaveQueue {
+	public:
+		struct Result {
+			std::string fileName;
+			bool succeeded;
+		};
+
+		void enqueue(const std::string& fileName, std::function<bool()> save);
+		std::vector<Result> takeFinished();
+		size_t pendingCount();
+		void waitForAll();
+
+	private:
+		void submit(const std::string& fileName, std::function<bool()> save);
+
+		std::mutex mutex;
+		std::condition_variable allFinished;
+		size_t pending = 0;
+		std::vector<Result> finished;
+		std::unordered_set<std::string> saving; // cards with a save running
+		std::unordered_map<std::string, std::function<bool()>> waiting; // the newest save queued behind each of them
+	};
+}
@@ -0,0 +1,522 @@
+#include "FlashcardStore.hpp"
+
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sys/stat.h>
+
+#include <opencv2/imgcodecs.hpp>
+
+#include <json.h>
+#include <StrUtils.hpp>
+#include <FlashcardImageCache.hpp>
+#include <FlashcardIndex.hpp>
+#include <FlashcardPack.hpp>
+#include <PixelSwizzle.hpp>
+#include <QoiCodec.hpp>
+#include <WorkerPool.hpp>
+
+namespace FlashcardStore {
+    namespace {
+        bool fileStamp(const std::string& path, long long& writeTime, uint64_t& fileSize) {
+            std::error_code ec;
+            auto lastWriteTime = std::filesystem::last_write_time(path, ec);
+            if (ec) return false;
+            fileSize = static_cast<uint64_t>(std::filesystem::file_size(path, ec));
+            if (ec) return false;
+            writeTime = static_cast<long long>(lastWriteTime.time_since_epoch().count());
+            return true;
+        }
+
+        //images are recognised by their header rather than their file name, so either format can be in a pack
+        cv::Mat decodeFlashcardImage(const unsigned char* encodedImage, size_t encodedSize) {
+            if (encodedSize == 0) return cv::Mat();
+            if (QoiCodec::isQoi(encodedImage, encodedSize)) {
+                return QoiCodec::decode(encodedImage, encodedSize);
+            }
+            cv::Mat encodedMat(1, static_cast<int>(encodedSize), CV_8UC1, const_cast<unsigned char*>(encodedImage));
+            cv::Mat bgrImage = cv::imdecode(encodedMat, cv::IMREAD_COLOR);
+            cv::Mat img;
+            if (!bgrImage.empty()) PixelSwizzle::bgrToRgba(bgrImage, img);
+            return img;
+        }
+
+        //a card saved loose after its topic was packed replaces the packed copy, as it will when the topic is packed again
+        bool isSavedLoose(const std::string& flashcardSavePath, const std::string& topic, const std::string& fileName) {
+            std::error_code ec;
+            return std::filesystem::exists(flashcardSavePath + "/" + topic + "/" + fileName + ".json", ec);
+        }
+
+        //written to a temporary file that is swapped in, so a failed write leaves the previous file alone
+        bool replaceFile(const std::string& path, const char* data, size_t size) {
+            std::string temporaryPath = path + ".tmp";
+            {
+                std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+                if (!file.write(data, size).good()) {
+                    file.close();
+                    std::error_code ec;
+                    std::filesystem::remove(temporaryPath, ec);
+                    return false;
+                }
+            }
+            std::error_code ec;
+            std::filesystem::rename(temporaryPath, path, ec);
+            return !ec;
+        }
+    }
+
+    void makeFileName(char* fileName) {
+        time_t t = time(0);
+        struct tm* now = localtime(&t);
+        strftime(fileName, 128, "Flashcard-%Y-%m-%d-%H-%M-%S", now);
+    }
+
+    std::vector<std::string> getAllTopics(const std::string& directory) {
+        std::vector<std::string> listOfTopics;
+        std::error_code ec;
+        for (const auto& dirEntry : std::filesystem::directory_iterator(directory, ec)) {
+            if (dirEntry.is_directory()) {
+                listOfTopics.push_back(dirEntry.path().filename().string());
+            }
+            else if (dirEntry.path().extension() == ".pack") {
+                listOfTopics.push_back(dirEntry.path().stem().string());
+            }
+        }
+        //a topic can have both a folder and a pack
+        std::sort(listOfTopics.begin(), listOfTopics.end());
+        listOfTopics.erase(std::unique(listOfTopics.begin(), listOfTopics.end()), listOfTopics.end());
+        return listOfTopics;
+    }
+
+    std::vector<std::string> parseTopics(const std::string& topicsFilter) {
+        std::vector<std::string> topics;
+        for (std::string topic : StrUtils::splitString(topicsFilter, ",")) {
+            StrUtils::trim(topic);
+            StrUtils::toLowercase(topic);
+            if (!topic.empty() && std::find(topics.begin(), topics.end(), topic) == topics.end()) {
+                topics.push_back(topic);
+            }
+        }
+        return topics;
+    }
+
+    std::vector<std::string> searchForFlashcards(std::string directory, std::string topic, std::vector<std::string> keywords, const std::atomic<bool>* cancelled) {
+        std::vector<std::string> flashcardFilenames;
+        // a topic can be packed into directory/topic.pack, have loose cards in directory/topic, or both
+        // packed cards are matched straight from the pack's mapped metadata table
+        // loose cards are looked up in the topic's keyword index (built from the json files the first time it is needed)
+        // the flashcards that have all the keywords listed in keywords are the intersection of the keywords' posting lists
+        bool topicFound = false;
+        if (std::shared_ptr<const FlashcardPack::MappedPack> topicPack = FlashcardPack::getTopicPack(directory, topic)) {
+            flashcardFilenames = FlashcardPack::query(*topicPack, keywords);
+            topicFound = true;
+        }
+
+        struct stat sb;
+        std::string flashcardDirectoryStr = std::string(directory + "/" + topic);
+        const char* flashcardDirectory = flashcardDirectoryStr.c_str();
+        if (stat(flashcardDirectory, &sb) == 0) {
+            std::shared_ptr<const FlashcardIndex::TopicIndex> topicIndex = FlashcardIndex::getTopicIndex(directory, topic, cancelled);
+            if (!topicIndex) {
+                return std::vector<std::string>();
+            }
+            std::vector<std::string> looseFlashcardFilenames = FlashcardIndex::query(*topicIndex, keywords);
+            if (flashcardFilenames.empty()) {
+                flashcardFilenames.swap(looseFlashcardFilenames);
+            }
+            else {
+                //packed cards that were saved loose since are only matched by their loose keywords
+                std::vector<std::string> packedFlashcardFilenames;
+                std::set_difference(flashcardFilenames.begin(), flashcardFilenames.end(),
+                    topicIndex->flashcardIds.begin(), topicIndex->flashcardIds.end(), std::back_inserter(packedFlashcardFilenames));
+                flashcardFilenames.clear();
+                std::set_union(packedFlashcardFilenames.begin(), packedFlashcardFilenames.end(),
+                    looseFlashcardFilenames.begin(), looseFlashcardFilenames.end(), std::back_inserter(flashcardFilenames));
+            }
+            topicFound = true;
+        }
+
+        if (!topicFound) {
+            std::cerr << "Error searching for flashcards:" << std::endl;
+            std::cerr << "Folder with name: " << topic << " not found." << std::endl;
+        }
+
+        return flashcardFilenames;
+    }
+
+    std::vector<std::string> parseKeywords(const std::string& keywordsFilter) {
+        std::vector<std::string> keywords;
+        for (std::string keyword : StrUtils::splitString(keywordsFilter, ",")) {
+            StrUtils::trim(keyword);
+            StrUtils::toLowercase(keyword);
+            if (!keyword.empty()) {
+                keywords.push_back(keyword);
+            }
+        }
+        std::sort(keywords.begin(), keywords.end());
+        keywords.erase(std::unique(keywords.begin(), keywords.end()), keywords.end());
+        return keywords;
+    }
+
+    std::vector<FlashcardRef> searchForFlashcards(const std::string& directory, const std::vector<std::string>& topics,
+        const std::vector<std::string>& keywords, const std::atomic<bool>* cancelled) {
+        std::vector<std::string> searchTopics = topics.empty() ? getAllTopics(directory) : topics;
+
+        //each topic has its own index or pack, so the topics are searched side by side
+        std::vector<std::vector<std::string>> topicFlashcards(searchTopics.size());
+        WorkerPool::shared().parallelFor(searchTopics.size(), [&](size_t i) {
+            topicFlashcards[i] = searchForFlashcards(directory, searchTopics[i], keywords, cancelled);
+        }, cancelled);
+        if (cancelled && *cancelled) {
+            return std::vector<FlashcardRef>();
+        }
+
+        std::vector<FlashcardRef> flashcards;
+        for (size_t i = 0; i < searchTopics.size(); i++) {
+            for (std::string& fileName : topicFlashcards[i]) {
+                flashcards.push_back({ searchTopics[i], std::move(fileName) });
+            }
+        }
+        return flashcards;
+    }
+
+    std::vector<FlashcardRef> refineSearch(const std::string& directory, const std::vector<FlashcardRef>& flashcards,
+        const std::vector<std::string>& keywords, const std::atomic<bool>* cancelled) {
+        //search results are grouped by topic and sorted by name within a topic
+        std::vector<std::pair<size_t, size_t>> topicRanges;
+        for (size_t i = 0; i < flashcards.size(); i++) {
+            if (topicRanges.empty() || flashcards[i].topic != flashcards[topicRanges.back().first].topic) {
+                topicRanges.push_back(std::make_pair(i, i));
+            }
+            topicRanges.back().second = i + 1;
+        }
+
+        std::vector<std::vector<std::string>> topicFlashcards(topicRanges.size());
+        WorkerPool::shared().parallelFor(topicRanges.size(), [&](size_t t) {
+            const std::string& topic = flashcards[topicRanges[t].first].topic;
+            std::vector<std::string> fileNames;
+            for (size_t i = topicRanges[t].first; i < topicRanges[t].second; i++) {
+                fileNames.push_back(flashcards[i].fileName);
+            }
+
+            std::vector<std::string> looseFileNames;
+            std::shared_ptr<const FlashcardIndex::TopicIndex> topicIndex;
+            std::error_code ec;
+            if (std::filesystem::is_directory(directory + "/" + topic, ec)) {
+                topicIndex = FlashcardIndex::getTopicIndex(directory, topic, cancelled);
+                if (topicIndex) {
+                    looseFileNames = FlashcardIndex::refine(*topicIndex, fileNames, keywords);
+                }
+            }
+            std::vector<std::string> packedFileNames;
+            if (std::shared_ptr<const FlashcardPack::MappedPack> topicPack = FlashcardPack::getTopicPack(directory, topic)) {
+                for (const std::string& fileName : fileNames) {
+                    //packed cards that were saved loose since are only matched by their loose keywords
+                    if (topicIndex && std::binary_search(topicIndex->flashcardIds.begin(), topicIndex->flashcardIds.end(), fileName)) continue;
+                    const FlashcardPack::PackFlashcard* packedFlashcard = topicPack->findFlashcard(fileName);
+                    if (packedFlashcard && FlashcardPack::hasKeywords(*topicPack, *packedFlashcard, keywords)) {
+                        packedFileNames.push_back(fileName);
+                    }
+                }
+            }
+            std::set_union(packedFileNames.begin(), packedFileNames.end(),
+                looseFileNames.begin(), looseFileNames.end(), std::back_inserter(topicFlashcards[t]));
+        }, cancelled);
+        if (cancelled && *cancelled) {
+            return std::vector<FlashcardRef>();
+        }
+
+        std::vector<FlashcardRef> refinedFlashcards;
+        for (size_t t = 0; t < topicRanges.size(); t++) {
+            const std::string& topic = flashcards[topicRanges[t].first].topic;
+            for (std::string& fileName : topicFlashcards[t]) {
+                refinedFlashcards.push_back({ topic, std::move(fileName) });
+            }
+        }
+        return refinedFlashcards;
+    }
+
+    cv::Mat loadFlashcardImage(std::string flashcardSavePath, std::string topic, std::string fileName, uint64_t* imageVersion) {
+        //decoded images are cached under the file they were decoded from, so rewriting the file misses the cache
+        FlashcardImageCache& imageCache = FlashcardImageCache::shared();
+        long long writeTime;
+        uint64_t fileSize;
+        uint64_t version = FlashcardImageCache::newVersion();
+        if (imageVersion) *imageVersion = version;
+
+        if (std::shared_ptr<const FlashcardPack::MappedPack> topicPack = FlashcardPack::getTopicPack(flashcardSavePath, topic)) {
+            const FlashcardPack::PackFlashcard* packedFlashcard = topicPack->findFlashcard(fileName);
+            if (packedFlashcard && !isSavedLoose(flashcardSavePath, topic, fileName)) {
+                std::string packPath = FlashcardPack::packPathForTopic(flashcardSavePath, topic);
+                std::string cacheKey = packPath + "/" + fileName;
+                bool stamped = fileStamp(packPath, writeTime, fileSize);
+                if (stamped) {
+                    cv::Mat cachedImage = imageCache.find(cacheKey, writeTime, fileSize, imageVersion);
+                    if (!cachedImage.empty()) return cachedImage;
+                }
+
+                //decode the image straight out of the mapping
+                cv::Mat img = decodeFlashcardImage(topicPack->image(*packedFlashcard), static_cast<size_t>(packedFlashcard->imageSize));
+                if (!img.empty()) {
+                    if (stamped) imageCache.insert(cacheKey, writeTime, fileSize, img, version);
+                }
+                return img;
+            }
+        }
+
+        //cached under the absolute path, so the same card is found however the save path was written
+        std::filesystem::path fnPath(flashcardImagePath(flashcardSavePath, topic, fileName));
+        std::string fnPathStr = std::filesystem::absolute(fnPath).string();
+        bool stamped = fileStamp(fnPathStr, writeTime, fileSize);
+        if (stamped) {
+            cv::Mat cachedImage = imageCache.find(fnPathStr, writeTime, fileSize, imageVersion);
+            if (!cachedImage.empty()) return cachedImage;
+        }
+        //read in one go, the file size is known from the stamp
+        if (!stamped) return cv::Mat();
+        std::ifstream imageFile(fnPathStr, std::ios::binary);
+        std::vector<unsigned char> encodedImage(static_cast<size_t>(fileSize));
+        if (!imageFile.read(reinterpret_cast<char*>(encodedImage.data()), encodedImage.size())) return cv::Mat();
+        cv::Mat img = decodeFlashcardImage(encodedImage.data(), encodedImage.size());
+        if (!img.empty()) {
+            if (stamped) imageCache.insert(fnPathStr, writeTime, fileSize, img, version);
+        }
+
+        return img;
+    }
+
+    ImageFormat imageFormatFromName(const std::string& name) {
+        if (name == "qoi") return ImageFormat::Qoi;
+        if (name != "png") std::cerr << "Unknown flashcard image format: " << name << ", saving PNG" << std::endl;
+        return ImageFormat::Png;
+    }
+
+    std::string flashcardImagePath(const std::string& flashcardSavePath, const std::string& topic, const std::string& fileName) {
+        std::string imageBasePath = flashcardSavePath + "/" + topic + "/" + fileName;
+        std::error_code ec;
+        if (std::filesystem::exists(imageBasePath + ".qoi", ec)) return imageBasePath + ".qoi";
+        return imageBasePath + ".png";
+    }
+
+    void loadFlashcardBoxBounds(std::string flashcardSavePath, std::string topic, std::string fileName,
+        std::vector<std::pair<cv::Point, cv::Point>>& answerBoxBounds,
+        std::vector<std::pair<cv::Point, cv::Point>>& questionBoxBounds) {
+
+        if (std::shared_ptr<const FlashcardPack::MappedPack> topicPack = FlashcardPack::getTopicPack(flashcardSavePath, topic)) {
+            const FlashcardPack::PackFlashcard* packedFlashcard = topicPack->findFlashcard(fileName);
+            if (packedFlashcard && !isSavedLoose(flashcardSavePath, topic, fileName)) {
+                const FlashcardPack::PackBox* answerBoxes = topicPack->answerBoxes(*packedFlashcard);
+                for (uint32_t i = 0; i < packedFlashcard->answerBoxCount; i++) {
+                    answerBoxBounds.push_back(std::make_pair(cv::Point(answerBoxes[i].x0, answerBoxes[i].y0), cv::Point(answerBoxes[i].x1, answerBoxes[i].y1)));
+                }
+                const FlashcardPack::PackBox* questionBoxes = topicPack->questionBoxes(*packedFlashcard);
+                for (uint32_t i = 0; i < packedFlashcard->questionBoxCount; i++) {
+                    questionBoxBounds.push_back(std::make_pair(cv::Point(questionBoxes[i].x0, questionBoxes[i].y0), cv::Point(questionBoxes[i].x1, questionBoxes[i].y1)));
+                }
+                return;
+            }
+        }
+
+        Json::Value root;
+        std::ifstream ifs;
+        ifs.open(flashcardSavePath + "/" + topic + "/" + fileName + ".json");
+
+        Json::CharReaderBuilder builder;
+        builder["collectComments"] = true;
+        JSONCPP_STRING errs;
+        if (!parseFromStream(builder, ifs, &root, &errs)) {
+            std::cerr << errs << std::endl;
+            return;
+        }
+
+        if (root.isMember("answerBoxPositionsList")) {
+            for (auto jsonBoxBounds : root["answerBoxPositionsList"]) {
+                cv::Point boxPosition(jsonBoxBounds[0][0].asInt(), jsonBoxBounds[0][1].asInt());
+                cv::Point boxEndPosition(jsonBoxBounds[1][0].asInt(), jsonBoxBounds[1][1].asInt());
+                std::pair<cv::Point, cv::Point> boxBounds(boxPosition, boxEndPosition);
+                answerBoxBounds.push_back(boxBounds);
+            }
+        }
+
+        if (root.isMember("questionBoxPositionsList")) {
+            for (auto jsonBoxBounds : root["questionBoxPositionsList"]) {
+                cv::Point boxPosition(jsonBoxBounds[0][0].asInt(), jsonBoxBounds[0][1].asInt());
+                cv::Point boxEndPosition(jsonBoxBounds[1][0].asInt(), jsonBoxBounds[1][1].asInt());
+                std::pair<cv::Point, cv::Point> boxBounds(boxPosition, boxEndPosition);
+                questionBoxBounds.push_back(boxBounds);
+            }
+        }
+    }
+
+    size_t exportTopicAsPng(const std::string& flashcardSavePath, const std::string& topic, const std::string& exportPath) {
+        std::error_code ec;
+        std::filesystem::create_directories(exportPath + "/" + topic, ec);
+        if (ec) {
+            std::cerr << "Error creating export folder: " << ec.message() << std::endl;
+            return 0;
+        }
+        size_t exported = 0;
+        for (const std::string& fileName : searchForFlashcards(flashcardSavePath, topic, std::vector<std::string>())) {
+            cv::Mat image = loadFlashcardImage(flashcardSavePath, topic, fileName);
+            cv::Mat bgraImage;
+            std::vector<unsigned char> encodedImage;
+            if (!image.empty()) {
+                PixelSwizzle::swapRedBlue(image, bgraImage);
+            }
+            if (image.empty() || !cv::imencode(".png", bgraImage, encodedImage) ||
+                !replaceFile(exportPath + "/" + topic + "/" + fileName + ".png", reinterpret_cast<const char*>(encodedImage.data()), encodedImage.size())) {
+                std::cerr << "Error exporting flashcard: " << topic << "/" << fileName << std::endl;
+                continue;
+            }
+            exported++;
+        }
+        return exported;
+    }
+
+    bool saveFlashcard(std::string flashcardSavePath, std::string topic, std::string fileName,
+        const std::vector<std::string>& keywords,
+        const std::vector<std::pair<cv::Point, cv::Point>>& answerBoxBounds,
+        const std::vector<std::pair<cv::Point, cv::Point>>& questionBoxBounds,
+        const cv::Mat& image, ImageFormat imageFormat) {
+
+        //create folder with topic's name
+        std::error_code ec;
+        std::filesystem::create_directories(flashcardSavePath + "/" + topic, ec);
+        if (ec) {
+            std::cerr << "Error creating flashcard folder: " << ec.message() << std::endl;
+            return false;
+        }
+
+        Json::Value saveJsonRoot;
+
+        //save meta-data
+        saveJsonRoot["topic"] = topic;
+        saveJsonRoot["keywords"] = Json::arrayValue;
+        for (const std::string& keyword : keywords) {
+            saveJsonRoot["keywords"].append(keyword);
+        }
+
+        //save boxes
+        int i = 0;
+        saveJsonRoot["answerBoxPositionsList"] = Json::arrayValue;
+        saveJsonRoot["questionBoxPositionsList"] = Json::arrayValue;
+        for (const auto& boxBoundsList : { answerBoxBounds, questionBoxBounds }) {
+            for (const std::pair<cv::Point, cv::Point>& boxBounds : boxBoundsList) {
+                Json::Value boxPositions = Json::arrayValue;
+                Json::Value boxTopLeftPosition = Json::arrayValue;
+                boxTopLeftPosition.append(boxBounds.first.x);
+                boxTopLeftPosition.append(boxBounds.first.y);
+                boxPositions.append(boxTopLeftPosition);
+                Json::Value boxBottomRightPosition = Json::arrayValue;
+                boxBottomRightPosition.append(boxBounds.second.x);
+                boxBottomRightPosition.append(boxBounds.second.y);
+                boxPositions.append(boxBottomRightPosition);
+                if (i == 0) {
+                    saveJsonRoot["answerBoxPositionsList"].append(boxPositions);
+                }
+                else {
+                    saveJsonRoot["questionBoxPositionsList"].append(boxPositions);
+                }
+            }
+            i++;
+        }
+
+        //the image is encoded before anything is written and the card's .json is replaced only once its image was,
+        //so a failed save leaves the previous image and boxes together. the .json going in last also means a
+        //watcher that picks the card up from it finds its image already there
+        std::string cardBasePath = flashcardSavePath + "/" + topic + "/" + fileName;
+        std::vector<unsigned char> encodedImage;
+        bool imageEncoded = false;
+        if (imageFormat == ImageFormat::Qoi) {
+            imageEncoded = QoiCodec::encode(image, encodedImage);
+        }
+        else {
+            cv::Mat bgraImage;
+            PixelSwizzle::swapRedBlue(image, bgraImage);
+            imageEncoded = cv::imencode(".png", bgraImage, encodedImage);
+        }
+        std::string imagePath = cardBasePath + (imageFormat == ImageFormat::Qoi ? ".qoi" : ".png");
+        if (!imageEncoded || !replaceFile(imagePath, reinterpret_cast<const char*>(encodedImage.data()), encodedImage.size())) {
+            std::cerr << "Error saving flashcard image." << std::endl;
+            return false;
+        }
+        //a copy in the other format left by an earlier save of the same card is stale now
+        std::filesystem::remove(cardBasePath + (imageFormat == ImageFormat::Qoi ? ".png" : ".qoi"), ec);
+
+        //save flashcard configuration
+        Json::StreamWriterBuilder builder;
+        std::string savedJson = Json::writeString(builder, saveJsonRoot);
+        if (!replaceFile(cardBasePath + ".json", savedJson.data(), savedJson.size())) {
+            std::cerr << "Error saving flashcard configuration." << std::endl;
+            return false;
+        }
+
+        //keep the topic's keyword index in step with the saved card
+        FlashcardIndex::addFlashcard(flashcardSavePath, topic, fileName, keywords);
+        return true;
+    }
+
+    void SaveQueue::enqueue(const std::string& fileName, std::function<bool()> save) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending++;
+            if (!saving.insert(fileName).second) {
+                //writing the same files from two tasks at once could interleave them, so this save waits its turn.
+                //an older one still waiting would only be overwritten by it, so it is dropped
+                auto older = waiting.find(fileName);
+                if (older != waiting.end()) {
+                    older->second = std::move(save);
+                    pending--;
+                }
+                else {
+                    waiting.emplace(fileName, std::move(save));
+                }
+                return;
+            }
+        }
+        submit(fileName, std::move(save));
+    }
+
+    void SaveQueue::submit(const std::string& fileName, std::function<bool()> save) {
+        WorkerPool::shared().submit([this, fileName, save]() {
+            bool succeeded = save();
+            std::function<bool()> next;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.push_back({ fileName, succeeded });
+                pending--;
+                auto waitingSave = waiting.find(fileName);
+                if (waitingSave != waiting.end()) {
+                    next = std::move(waitingSave->second);
+                    waiting.erase(waitingSave);
+                }
+                else {
+                    saving.erase(fileName);
+                }
+                allFinished.notify_all();
+            }
+            if (next) submit(fileName, std::move(next));
+        });
+    }
+
+    std::vector<SaveQueue::Result> SaveQueue::takeFinished() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<Result> results;
+        results.swap(finished);
+        return results;
+    }
+
+    size_t SaveQueue::pendingCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return pending;
+    }
+
+    void SaveQueue::waitForAll() {
+        std::unique_lock<std::mutex> lock(mutex);
+        allFinished.wait(lock, [this]() { return pending == 0; });
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// milliseconds spent in each stage of the main loop over the last historyLength frames. stages are timed with
+// Scope and appear in the order they were first timed; a stage timed more than once in a frame adds up, and a
+// stage timed inside another one is included in it
+//
+// only used from the ui thread
+class FrameProfiler {
+public:
+	explicit FrameProfiler(size_t historyLength = 240);
+
+	class Scope {
+	public:
+		Scope(FrameProfiler& profiler, const char* stage);
+		~Scope();
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+		// ends the stage before the scope does
+		void stop();
+
+	private:
+		FrameProfiler& profiler;
+		const char* stage;
+		std::chrono::steady_clock::time_point start;
+		bool stopped = false;
+	};
+
+	void beginFrame();
+	// records this frame's stage timings, stages that were not timed this frame record 0
+	void endFrame();
+	void addTime(const char* stage, double milliseconds);
+
+	// ImGui window with a rolling histogram and the average and worst time of every stage
+	void drawOverlay(bool* open);
+	// writes the recorded frames as csv, one row per frame and one column per stage, oldest first
+	bool dump(const std::string& path) const;
+
+	// where the overlay's dump button writes to
+	std::string dumpPath = "frameProfile.csv";
+
+private:
+	struct Stage {
+		std::string name;
+		std::vector<float> history;
+		double frameMilliseconds = 0.0;
+	};
+
+	Stage& stage(const char* name);
+
+	size_t historyLength;
+	size_t nextFrame = 0;     // history slot the next frame is recorded in
+	size_t recordedFrames = 0;
+	std::chrono::steady_clock::time_point frameStart;
+	std::vector<Stage> stages; // "frame" first, then the stages in the order they were first timed
+};
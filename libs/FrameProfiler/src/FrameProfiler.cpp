@@ -0,0 +1,105 @@
+#include "FrameProfiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "imgui.h"
+
+FrameProfiler::FrameProfiler(size_t historyLength)
+    : historyLength(std::max<size_t>(historyLength, 1)) {
+    stage("frame");
+}
+
+FrameProfiler::Scope::Scope(FrameProfiler& profiler, const char* stage)
+    : profiler(profiler), stage(stage), start(std::chrono::steady_clock::now()) {
+}
+
+FrameProfiler::Scope::~Scope() {
+    stop();
+}
+
+void FrameProfiler::Scope::stop() {
+    if (stopped) return;
+    profiler.addTime(stage, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    stopped = true;
+}
+
+FrameProfiler::Stage& FrameProfiler::stage(const char* name) {
+    for (Stage& existingStage : stages) {
+        if (existingStage.name == name) return existingStage;
+    }
+    stages.push_back({ name, std::vector<float>(historyLength, 0.0f), 0.0 });
+    return stages.back();
+}
+
+void FrameProfiler::beginFrame() {
+    frameStart = std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::addTime(const char* name, double milliseconds) {
+    stage(name).frameMilliseconds += milliseconds;
+}
+
+void FrameProfiler::endFrame() {
+    addTime("frame", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+    for (Stage& frameStage : stages) {
+        frameStage.history[nextFrame] = static_cast<float>(frameStage.frameMilliseconds);
+        frameStage.frameMilliseconds = 0.0;
+    }
+    nextFrame = (nextFrame + 1) % historyLength;
+    recordedFrames = std::min(recordedFrames + 1, historyLength);
+}
+
+void FrameProfiler::drawOverlay(bool* open) {
+    ImGui::SetNextWindowBgAlpha(0.85f);
+    if (!ImGui::Begin("Frame profiler", open)) {
+        ImGui::End();
+        return;
+    }
+
+    size_t oldestFrame = recordedFrames < historyLength ? 0 : nextFrame;
+    for (const Stage& frameStage : stages) {
+        float total = 0.0f;
+        float worst = 0.0f;
+        for (size_t i = 0; i < recordedFrames; i++) {
+            float milliseconds = frameStage.history[(oldestFrame + i) % historyLength];
+            total += milliseconds;
+            worst = std::max(worst, milliseconds);
+        }
+        float average = recordedFrames > 0 ? total / recordedFrames : 0.0f;
+        char overlay[64];
+        std::snprintf(overlay, sizeof(overlay), "avg %.2f ms, max %.2f ms", average, worst);
+        ImGui::PlotHistogram(frameStage.name.c_str(), frameStage.history.data(), static_cast<int>(historyLength),
+            static_cast<int>(nextFrame), overlay, 0.0f, std::max(worst, 1.0f), ImVec2(360, 40));
+    }
+
+    if (ImGui::Button("Dump to file")) {
+        if (dump(dumpPath)) std::cout << "Wrote frame profile: " << dumpPath << std::endl;
+    }
+    ImGui::SameLine();
+    ImGui::Text("%s", dumpPath.c_str());
+    ImGui::End();
+}
+
+bool FrameProfiler::dump(const std::string& path) const {
+    std::ofstream ofs(path);
+    if (!ofs.is_open()) {
+        std::cerr << "Error writing frame profile: " << path << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < stages.size(); i++) {
+        ofs << (i > 0 ? "," : "") << stages[i].name;
+    }
+    ofs << "\n";
+    size_t oldestFrame = recordedFrames < historyLength ? 0 : nextFrame;
+    for (size_t frame = 0; frame < recordedFrames; frame++) {
+        for (size_t i = 0; i < stages.size(); i++) {
+            ofs << (i > 0 ? "," : "") << stages[i].history[(oldestFrame + frame) % historyLength];
+        }
+        ofs << "\n";
+    }
+    return ofs.good();
+}
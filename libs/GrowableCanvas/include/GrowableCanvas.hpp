@@ -0,0 +1,43 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+// the editor's card image, kept as a view into a larger buffer so it can grow in any direction without
+// copying. a paste that reaches past the image only moves the view's bounds while the buffer has room, and
+// when it does not the buffer is reallocated with as much spare room again on the sides that grew, so a
+// collage of n pastes copies every pixel a constant number of times instead of n times. crops only move the
+// view's bounds too
+//
+// positions on the card that have to survive growing and cropping (the answer and question boxes) are kept
+// relative to origin(), which stays on the same card pixel however the image grows
+class GrowableCanvas {
+public:
+	explicit GrowableCanvas(const cv::Mat& image, cv::Scalar background = cv::Scalar(255, 255, 255, 255));
+
+	// starts over from image, sharing its pixels until the canvas is drawn into
+	void reset(const cv::Mat& image);
+
+	// the card image. it shares the canvas' pixels, a copy kept by a pending save stays unchanged because
+	// writableImage() and paste() give the canvas its own pixels first
+	cv::Mat image() const { return buffer(bounds); }
+	// the card image to draw into
+	cv::Mat writableImage();
+	cv::Size size() const { return bounds.size(); }
+	// position of the stable origin in image pixels
+	cv::Point origin() const { return originInBuffer - bounds.tl(); }
+
+	// copies source onto the card with its top left at pos (in image pixels), growing the card to cover it.
+	// returns the region pasted over in the grown image's pixels
+	cv::Rect paste(const cv::Mat& source, cv::Point pos);
+	// cuts the card down to region (in image pixels), the pixels cut away are only forgotten
+	void crop(const cv::Rect& region);
+
+private:
+	// makes room for needed (in buffer pixels, covering bounds), reallocating when the buffer is too small or shared
+	void grow(cv::Rect& needed);
+
+	cv::Scalar background;
+	cv::Mat buffer;
+	cv::Rect bounds;          // the image inside buffer
+	cv::Point originInBuffer;
+};
@@ -0,0 +1,90 @@
+#include "GrowableCanvas.hpp"
+
+#include <algorithm>
+
+namespace {
+    bool isShared(const cv::Mat& mat) {
+        return mat.u && mat.u->refcount > 1;
+    }
+
+    //fills the part of region that is outside of keep
+    void fillAround(cv::Mat& mat, const cv::Rect& region, const cv::Rect& keep, cv::Scalar color) {
+        cv::Rect kept = region & keep;
+        if (kept.empty()) {
+            mat(region).setTo(color);
+            return;
+        }
+        cv::Rect above(region.x, region.y, region.width, kept.y - region.y);
+        cv::Rect below(region.x, kept.br().y, region.width, region.br().y - kept.br().y);
+        cv::Rect left(region.x, kept.y, kept.x - region.x, kept.height);
+        cv::Rect right(kept.br().x, kept.y, region.br().x - kept.br().x, kept.height);
+        for (const cv::Rect& strip : { above, below, left, right }) {
+            if (!strip.empty()) mat(strip).setTo(color);
+        }
+    }
+}
+
+GrowableCanvas::GrowableCanvas(const cv::Mat& image, cv::Scalar background)
+    : background(background) {
+    reset(image);
+}
+
+void GrowableCanvas::reset(const cv::Mat& image) {
+    buffer = image;
+    bounds = cv::Rect(0, 0, image.cols, image.rows);
+    originInBuffer = cv::Point(0, 0);
+}
+
+cv::Mat GrowableCanvas::writableImage() {
+    if (isShared(buffer)) {
+        cv::Rect needed = bounds;
+        grow(needed);
+    }
+    return image();
+}
+
+void GrowableCanvas::grow(cv::Rect& needed) {
+    cv::Rect bufferRect(0, 0, buffer.cols, buffer.rows);
+    if ((needed & bufferRect) == needed && !isShared(buffer)) {
+        fillAround(buffer, needed, bounds, background);
+        bounds = needed;
+        return;
+    }
+
+    //every side that grew gets as much spare room again as the new image is wide or tall, sides that did
+    //not grow get none, so growing the same way again is bookkeeping until the image has doubled
+    int spareLeft = needed.x < bounds.x ? needed.width : 0;
+    int spareRight = needed.br().x > bounds.br().x ? needed.width : 0;
+    int spareTop = needed.y < bounds.y ? needed.height : 0;
+    int spareBottom = needed.br().y > bounds.br().y ? needed.height : 0;
+    cv::Mat grownBuffer(needed.height + spareTop + spareBottom, needed.width + spareLeft + spareRight, buffer.type());
+
+    //buffer pixels of the old buffer move by shift in the new one
+    cv::Point shift(spareLeft - needed.x, spareTop - needed.y);
+    cv::Rect grownBounds(spareLeft, spareTop, needed.width, needed.height);
+    cv::Rect oldBounds = bounds + shift;
+    buffer(bounds).copyTo(grownBuffer(oldBounds));
+    fillAround(grownBuffer, grownBounds, oldBounds, background);
+
+    buffer = grownBuffer;
+    bounds = grownBounds;
+    originInBuffer += shift;
+    needed = grownBounds;
+}
+
+cv::Rect GrowableCanvas::paste(const cv::Mat& source, cv::Point pos) {
+    cv::Rect pasted(pos + bounds.tl(), source.size());
+    cv::Rect needed = bounds | pasted;
+    cv::Point shift = -needed.tl();
+    grow(needed);
+    shift += needed.tl();
+    pasted += shift;
+    source.copyTo(buffer(pasted));
+    return pasted - bounds.tl();
+}
+
+void GrowableCanvas::crop(const cv::Rect& region) {
+    cv::Rect cropped = (region + bounds.tl()) & bounds;
+    if (cropped.empty()) return;
+    bounds = cropped;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <opencv2/core.hpp>
+
+// channel order conversions between the editor's RGBA and OpenCV's BGR(A), done with byte shuffles (AVX2 or
+// SSSE3, picked once at runtime from what the cpu supports, with a plain loop everywhere else). each pixel is
+// read and written once, straight from the source rows into the destination rows
+//
+// safe to call from any thread
+namespace PixelSwizzle {
+	// "avx2", "ssse3" or "scalar"
+	const char* implementationName();
+
+	// RGBA <-> BGRA, dst may be src
+	void swapRedBlue(const cv::Mat& src, cv::Mat& dst);
+	// BGRX (4 bytes per pixel with a padding byte, like a screen capture) to opaque RGBA, dst may be src
+	void bgrxToRgba(const cv::Mat& src, cv::Mat& dst);
+	// BGR (what cv::imdecode gives) to opaque RGBA, dst must not be src
+	void bgrToRgba(const cv::Mat& src, cv::Mat& dst);
+
+	// the row kernels behind them, pixelCount pixels from src to dst
+	void swapRedBlueRow(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+	void bgrxToRgbaRow(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+	void bgrToRgbaRow(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+}
@@ -0,0 +1,173 @@
+#include "PixelSwizzle.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PIXELSWIZZLE_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+//gcc and clang only emit the shuffles in functions marked for the instruction set, msvc always does
+#if defined(PIXELSWIZZLE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PIXELSWIZZLE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PIXELSWIZZLE_TARGET(isa)
+#endif
+
+namespace PixelSwizzle {
+    namespace {
+        const uint32_t opaqueAlpha = 0xFF000000u;
+
+        //pixels are read as little endian words, so R (or B) is the low byte and alpha the high one
+        void swapRedBlueScalar(const uint8_t* src, uint8_t* dst, size_t pixelCount, uint32_t alpha) {
+            for (size_t i = 0; i < pixelCount; i++) {
+                uint32_t pixel;
+                std::memcpy(&pixel, src + i * 4, 4);
+                pixel = ((pixel & 0xFF) << 16) | (pixel & 0xFF00FF00u) | ((pixel >> 16) & 0xFF) | alpha;
+                std::memcpy(dst + i * 4, &pixel, 4);
+            }
+        }
+
+        void bgrToRgbaScalar(const uint8_t* src, uint8_t* dst, size_t pixelCount) {
+            for (size_t i = 0; i < pixelCount; i++) {
+                dst[i * 4 + 0] = src[i * 3 + 2];
+                dst[i * 4 + 1] = src[i * 3 + 1];
+                dst[i * 4 + 2] = src[i * 3 + 0];
+                dst[i * 4 + 3] = 255;
+            }
+        }
+
+#ifdef PIXELSWIZZLE_X86
+        PIXELSWIZZLE_TARGET("ssse3")
+        void swapRedBlueSsse3(const uint8_t* src, uint8_t* dst, size_t pixelCount, uint32_t alpha) {
+            const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+            const __m128i alphaBits = _mm_set1_epi32(static_cast<int>(alpha));
+            size_t i = 0;
+            for (; i + 4 <= pixelCount; i += 4) {
+                __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alphaBits));
+            }
+            swapRedBlueScalar(src + i * 4, dst + i * 4, pixelCount - i, alpha);
+        }
+
+        PIXELSWIZZLE_TARGET("ssse3")
+        void bgrToRgbaSsse3(const uint8_t* src, uint8_t* dst, size_t pixelCount) {
+            //4 pixels come from the first 12 of the 16 bytes loaded, so the loop stops while 16 bytes are left to read
+            const __m128i shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+            const __m128i alphaBits = _mm_set1_epi32(static_cast<int>(opaqueAlpha));
+            size_t i = 0;
+            for (; i + 6 <= pixelCount; i += 4) {
+                __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alphaBits));
+            }
+            bgrToRgbaScalar(src + i * 3, dst + i * 4, pixelCount - i);
+        }
+
+        PIXELSWIZZLE_TARGET("avx2")
+        void swapRedBlueAvx2(const uint8_t* src, uint8_t* dst, size_t pixelCount, uint32_t alpha) {
+            const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+            const __m256i alphaBits = _mm256_set1_epi32(static_cast<int>(alpha));
+            size_t i = 0;
+            for (; i + 8 <= pixelCount; i += 8) {
+                __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffle), alphaBits));
+            }
+            swapRedBlueScalar(src + i * 4, dst + i * 4, pixelCount - i, alpha);
+        }
+
+        PIXELSWIZZLE_TARGET("avx2")
+        void bgrToRgbaAvx2(const uint8_t* src, uint8_t* dst, size_t pixelCount) {
+            //the shuffle stays within 128 bit lanes, so the upper lane is first given bytes 12 to 27 of the 32 loaded
+            const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+            const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+                2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+            const __m256i alphaBits = _mm256_set1_epi32(static_cast<int>(opaqueAlpha));
+            size_t i = 0;
+            for (; i + 11 <= pixelCount; i += 8) {
+                __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 3));
+                pixels = _mm256_permutevar8x32_epi32(pixels, lanes);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffle), alphaBits));
+            }
+            bgrToRgbaSsse3(src + i * 3, dst + i * 4, pixelCount - i);
+        }
+
+        bool cpuSupports(bool avx2) {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 1);
+            bool ssse3 = (info[2] & (1 << 9)) != 0;
+            if (!avx2) return ssse3;
+            //the os has to save the ymm registers too
+            bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+            __cpuidex(info, 7, 0);
+            return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+            __builtin_cpu_init();
+            return avx2 ? __builtin_cpu_supports("avx2") : __builtin_cpu_supports("ssse3");
+#endif
+        }
+#endif
+
+        struct Kernels {
+            const char* name;
+            void (*swapRedBlue)(const uint8_t*, uint8_t*, size_t, uint32_t);
+            void (*bgrToRgba)(const uint8_t*, uint8_t*, size_t);
+        };
+
+        const Kernels& kernels() {
+            static const Kernels selected = []() {
+#ifdef PIXELSWIZZLE_X86
+                if (cpuSupports(true)) return Kernels{ "avx2", swapRedBlueAvx2, bgrToRgbaAvx2 };
+                if (cpuSupports(false)) return Kernels{ "ssse3", swapRedBlueSsse3, bgrToRgbaSsse3 };
+#endif
+                return Kernels{ "scalar", swapRedBlueScalar, bgrToRgbaScalar };
+            }();
+            return selected;
+        }
+
+        //continuous images are converted in one call, others (like a cropped canvas) row by row
+        template<typename RowKernel>
+        void convertRows(const cv::Mat& src, cv::Mat& dst, RowKernel rowKernel) {
+            dst.create(src.size(), CV_8UC4);
+            if (src.isContinuous() && dst.isContinuous()) {
+                rowKernel(src.ptr<uint8_t>(0), dst.ptr<uint8_t>(0), src.total());
+                return;
+            }
+            for (int y = 0; y < src.rows; y++) {
+                rowKernel(src.ptr<uint8_t>(y), dst.ptr<uint8_t>(y), static_cast<size_t>(src.cols));
+            }
+        }
+    }
+
+    const char* implementationName() {
+        return kernels().name;
+    }
+
+    void swapRedBlueRow(const uint8_t* src, uint8_t* dst, size_t pixelCount) {
+        kernels().swapRedBlue(src, dst, pixelCount, 0);
+    }
+
+    void bgrxToRgbaRow(const uint8_t* src, uint8_t* dst, size_t pixelCount) {
+        kernels().swapRedBlue(src, dst, pixelCount, opaqueAlpha);
+    }
+
+    void bgrToRgbaRow(const uint8_t* src, uint8_t* dst, size_t pixelCount) {
+        kernels().bgrToRgba(src, dst, pixelCount);
+    }
+
+    void swapRedBlue(const cv::Mat& src, cv::Mat& dst) {
+        convertRows(src, dst, swapRedBlueRow);
+    }
+
+    void bgrxToRgba(const cv::Mat& src, cv::Mat& dst) {
+        convertRows(src, dst, bgrxToRgbaRow);
+    }
+
+    void bgrToRgba(const cv::Mat& src, cv::Mat& dst) {
+        convertRows(src, dst, bgrToRgbaRow);
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+// the QOI image format (https://qoiformat.org), a lossless format that encodes each pixel as a run, an index
+// into the last 64 colors seen or a small difference to the previous pixel. it compresses flat screenshot
+// content about as well as PNG at a fraction of the cost, and works on RGBA directly so the editor's images
+// need no channel swap on the way in or out
+//
+// images are always written with 4 channels, 3 channel files are read too
+namespace QoiCodec {
+	// whether data starts with a QOI header
+	bool isQoi(const unsigned char* data, size_t size);
+	// encodes an RGBA image, false if it is empty or too large for the format
+	bool encode(const cv::Mat& image, std::vector<unsigned char>& encoded);
+	// decodes to an RGBA image, or an empty Mat if data is not a valid QOI image
+	cv::Mat decode(const unsigned char* data, size_t size);
+}
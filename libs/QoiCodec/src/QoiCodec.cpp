@@ -0,0 +1,191 @@
+#include "QoiCodec.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace QoiCodec {
+    namespace {
+        const unsigned char magic[4] = { 'q', 'o', 'i', 'f' };
+        const size_t headerSize = 14;
+        const unsigned char endMarker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+        //the format's own limit, which also keeps a corrupt header from asking for an absurd allocation
+        const uint64_t maxPixels = 400000000;
+
+        const unsigned char opIndex = 0x00;
+        const unsigned char opDiff = 0x40;
+        const unsigned char opLuma = 0x80;
+        const unsigned char opRun = 0xc0;
+        const unsigned char opRgb = 0xfe;
+        const unsigned char opRgba = 0xff;
+        const unsigned char opMask = 0xc0;
+        const int maxRun = 62;
+
+        struct Pixel {
+            unsigned char r, g, b, a;
+        };
+
+        bool operator==(const Pixel& a, const Pixel& b) {
+            return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+        }
+
+        int colorHash(const Pixel& px) {
+            return (px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64;
+        }
+
+        void writeBigEndian(unsigned char* out, uint32_t value) {
+            out[0] = static_cast<unsigned char>(value >> 24);
+            out[1] = static_cast<unsigned char>(value >> 16);
+            out[2] = static_cast<unsigned char>(value >> 8);
+            out[3] = static_cast<unsigned char>(value);
+        }
+
+        uint32_t readBigEndian(const unsigned char* in) {
+            return (uint32_t(in[0]) << 24) | (uint32_t(in[1]) << 16) | (uint32_t(in[2]) << 8) | uint32_t(in[3]);
+        }
+    }
+
+    bool isQoi(const unsigned char* data, size_t size) {
+        return size >= headerSize && std::memcmp(data, magic, sizeof(magic)) == 0;
+    }
+
+    bool encode(const cv::Mat& image, std::vector<unsigned char>& encoded) {
+        if (image.empty() || image.type() != CV_8UC4 || static_cast<uint64_t>(image.total()) > maxPixels) return false;
+
+        //written straight into a buffer sized for the worst case (every pixel a full RGBA op), then trimmed
+        encoded.resize(headerSize + image.total() * 5 + sizeof(endMarker));
+        unsigned char* out = encoded.data();
+        std::memcpy(out, magic, sizeof(magic));
+        writeBigEndian(out + 4, static_cast<uint32_t>(image.cols));
+        writeBigEndian(out + 8, static_cast<uint32_t>(image.rows));
+        out[12] = 4;
+        out[13] = 0;
+        size_t p = headerSize;
+
+        Pixel index[64] = {};
+        Pixel previous = { 0, 0, 0, 255 };
+        int run = 0;
+        for (int y = 0; y < image.rows; y++) {
+            const Pixel* row = image.ptr<Pixel>(y);
+            for (int x = 0; x < image.cols; x++) {
+                Pixel px = row[x];
+                if (px == previous) {
+                    run++;
+                    if (run == maxRun) {
+                        out[p++] = opRun | (run - 1);
+                        run = 0;
+                    }
+                    continue;
+                }
+                if (run > 0) {
+                    out[p++] = opRun | (run - 1);
+                    run = 0;
+                }
+
+                int hash = colorHash(px);
+                if (index[hash] == px) {
+                    out[p++] = opIndex | hash;
+                }
+                else {
+                    index[hash] = px;
+                    if (px.a == previous.a) {
+                        //differences wrap around like the 8 bit channels they are taken between
+                        int dr = static_cast<signed char>(px.r - previous.r);
+                        int dg = static_cast<signed char>(px.g - previous.g);
+                        int db = static_cast<signed char>(px.b - previous.b);
+                        int drg = dr - dg;
+                        int dbg = db - dg;
+                        if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                            out[p++] = opDiff | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2);
+                        }
+                        else if (drg >= -8 && drg <= 7 && dg >= -32 && dg <= 31 && dbg >= -8 && dbg <= 7) {
+                            out[p++] = opLuma | (dg + 32);
+                            out[p++] = static_cast<unsigned char>(((drg + 8) << 4) | (dbg + 8));
+                        }
+                        else {
+                            out[p++] = opRgb;
+                            out[p++] = px.r;
+                            out[p++] = px.g;
+                            out[p++] = px.b;
+                        }
+                    }
+                    else {
+                        out[p++] = opRgba;
+                        out[p++] = px.r;
+                        out[p++] = px.g;
+                        out[p++] = px.b;
+                        out[p++] = px.a;
+                    }
+                }
+                previous = px;
+            }
+        }
+        if (run > 0) {
+            out[p++] = opRun | (run - 1);
+        }
+        std::memcpy(out + p, endMarker, sizeof(endMarker));
+        encoded.resize(p + sizeof(endMarker));
+        return true;
+    }
+
+    cv::Mat decode(const unsigned char* data, size_t size) {
+        if (!isQoi(data, size) || size < headerSize + sizeof(endMarker)) return cv::Mat();
+        uint32_t width = readBigEndian(data + 4);
+        uint32_t height = readBigEndian(data + 8);
+        unsigned char channels = data[12];
+        if (width == 0 || height == 0 || (channels != 3 && channels != 4) || uint64_t(width) * height > maxPixels) {
+            return cv::Mat();
+        }
+
+        cv::Mat image(static_cast<int>(height), static_cast<int>(width), CV_8UC4);
+        Pixel* out = image.ptr<Pixel>(0);
+        size_t pixelCount = image.total();
+
+        //the end marker is 8 bytes, so every op that starts before it can read its payload without a bounds check
+        size_t chunksEnd = size - sizeof(endMarker);
+        size_t p = headerSize;
+        Pixel index[64] = {};
+        Pixel px = { 0, 0, 0, 255 };
+        int run = 0;
+        for (size_t i = 0; i < pixelCount; i++) {
+            if (run > 0) {
+                run--;
+            }
+            else {
+                if (p >= chunksEnd) return cv::Mat();
+                unsigned char op = data[p++];
+                if (op == opRgb) {
+                    px.r = data[p++];
+                    px.g = data[p++];
+                    px.b = data[p++];
+                }
+                else if (op == opRgba) {
+                    px.r = data[p++];
+                    px.g = data[p++];
+                    px.b = data[p++];
+                    px.a = data[p++];
+                }
+                else if ((op & opMask) == opIndex) {
+                    px = index[op];
+                }
+                else if ((op & opMask) == opDiff) {
+                    px.r += ((op >> 4) & 0x03) - 2;
+                    px.g += ((op >> 2) & 0x03) - 2;
+                    px.b += (op & 0x03) - 2;
+                }
+                else if ((op & opMask) == opLuma) {
+                    unsigned char next = data[p++];
+                    int dg = (op & 0x3f) - 32;
+                    px.r += dg - 8 + ((next >> 4) & 0x0f);
+                    px.g += dg;
+                    px.b += dg - 8 + (next & 0x0f);
+                }
+                else {
+                    run = op & 0x3f;
+                }
+                index[colorHash(px)] = px;
+            }
+            out[i] = px;
+        }
+        return image;
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <memory>
+
+#include <opencv2/core.hpp>
+
+// grabs pixels straight off the screen into a buffer the backend owns, which is handed out as a BGRA cv::Mat
+// without copying it. on Linux the X11 backend grabs through MIT-SHM into shared memory (plain XGetImage when
+// the server has no MIT-SHM), on Windows the backend BitBlts into a DIB section. neither goes through the
+// clipboard, and the X11 backend only needs a display to connect to, so it also runs headless under Xvfb
+//
+// only used from one thread at a time
+class ScreenCapture {
+public:
+	virtual ~ScreenCapture() = default;
+
+	// the backend for this platform, or nullptr if the screen can not be captured
+	static std::unique_ptr<ScreenCapture> create();
+
+	// the whole virtual desktop, in screen pixels
+	virtual cv::Rect screenBounds() const = 0;
+	// grabs region (clipped to screenBounds()) into frame. frame shares the backend's buffer and is only
+	// valid until the next grab, copy or convert it to keep it
+	virtual bool grab(const cv::Rect& region, cv::Mat& frame) = 0;
+};
@@ -0,0 +1,229 @@
+#include "ScreenCapture.hpp"
+
+#include <iostream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#endif
+
+namespace {
+#if defined(_WIN32)
+    class Win32ScreenCapture : public ScreenCapture {
+    public:
+        Win32ScreenCapture() {
+            memoryDC = CreateCompatibleDC(nullptr);
+        }
+
+        ~Win32ScreenCapture() override {
+            releaseBitmap();
+            DeleteDC(memoryDC);
+        }
+
+        cv::Rect screenBounds() const override {
+            return cv::Rect(GetSystemMetrics(SM_XVIRTUALSCREEN), GetSystemMetrics(SM_YVIRTUALSCREEN),
+                GetSystemMetrics(SM_CXVIRTUALSCREEN), GetSystemMetrics(SM_CYVIRTUALSCREEN));
+        }
+
+        bool grab(const cv::Rect& region, cv::Mat& frame) override {
+            cv::Rect clipped = region & screenBounds();
+            if (clipped.empty()) return false;
+            if (bitmap == nullptr || bitmapSize != clipped.size()) {
+                releaseBitmap();
+                if (!createBitmap(clipped.size())) return false;
+            }
+
+            HDC screenDC = GetDC(nullptr);
+            BOOL copied = BitBlt(memoryDC, 0, 0, clipped.width, clipped.height, screenDC, clipped.x, clipped.y, SRCCOPY | CAPTUREBLT);
+            ReleaseDC(nullptr, screenDC);
+            GdiFlush();
+            if (!copied) {
+                std::cerr << "Error capturing the screen" << std::endl;
+                return false;
+            }
+            frame = cv::Mat(clipped.height, clipped.width, CV_8UC4, bits);
+            return true;
+        }
+
+    private:
+        //a top down 32 bit DIB section, which BitBlt writes into and the frame wraps
+        bool createBitmap(cv::Size size) {
+            BITMAPINFO bitmapInfo = {};
+            bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+            bitmapInfo.bmiHeader.biWidth = size.width;
+            bitmapInfo.bmiHeader.biHeight = -size.height;
+            bitmapInfo.bmiHeader.biPlanes = 1;
+            bitmapInfo.bmiHeader.biBitCount = 32;
+            bitmapInfo.bmiHeader.biCompression = BI_RGB;
+            bitmap = CreateDIBSection(memoryDC, &bitmapInfo, DIB_RGB_COLORS, &bits, nullptr, 0);
+            if (bitmap == nullptr) {
+                std::cerr << "Error creating the screen capture bitmap" << std::endl;
+                return false;
+            }
+            previousBitmap = SelectObject(memoryDC, bitmap);
+            bitmapSize = size;
+            return true;
+        }
+
+        void releaseBitmap() {
+            if (bitmap == nullptr) return;
+            SelectObject(memoryDC, previousBitmap);
+            DeleteObject(bitmap);
+            bitmap = nullptr;
+            bits = nullptr;
+        }
+
+        HDC memoryDC = nullptr;
+        HBITMAP bitmap = nullptr;
+        HGDIOBJ previousBitmap = nullptr;
+        void* bits = nullptr;
+        cv::Size bitmapSize;
+    };
+#elif defined(__linux__)
+    //XShmAttach fails asynchronously, e.g. on a remote display, so its error is caught with a temporary handler
+    bool shmAttachFailed = false;
+    int catchShmAttachError(Display*, XErrorEvent*) {
+        shmAttachFailed = true;
+        return 0;
+    }
+
+    class X11ScreenCapture : public ScreenCapture {
+    public:
+        ~X11ScreenCapture() override {
+            releaseImage();
+            if (display != nullptr) XCloseDisplay(display);
+        }
+
+        bool open() {
+            display = XOpenDisplay(nullptr);
+            if (display == nullptr) {
+                std::cerr << "Error opening the X display for screen capture" << std::endl;
+                return false;
+            }
+            root = DefaultRootWindow(display);
+            useShm = XShmQueryExtension(display) == True;
+            return true;
+        }
+
+        cv::Rect screenBounds() const override {
+            XWindowAttributes attributes;
+            if (!XGetWindowAttributes(display, root, &attributes)) return cv::Rect();
+            return cv::Rect(0, 0, attributes.width, attributes.height);
+        }
+
+        bool grab(const cv::Rect& region, cv::Mat& frame) override {
+            cv::Rect clipped = region & screenBounds();
+            if (clipped.empty()) return false;
+
+            //the shared image is kept while the region keeps its size, so repeated grabs only ask the server to copy
+            if (useShm && (image == nullptr || image->width != clipped.width || image->height != clipped.height)) {
+                releaseImage();
+                if (!createShmImage(clipped.size())) {
+                    std::cerr << "MIT-SHM unavailable, capturing the screen with XGetImage" << std::endl;
+                    useShm = false;
+                }
+            }
+            if (useShm) {
+                if (!XShmGetImage(display, root, image, clipped.x, clipped.y, AllPlanes)) {
+                    std::cerr << "Error capturing the screen" << std::endl;
+                    return false;
+                }
+            }
+            else {
+                releaseImage();
+                image = XGetImage(display, root, clipped.x, clipped.y, clipped.width, clipped.height, AllPlanes, ZPixmap);
+                if (image == nullptr) {
+                    std::cerr << "Error capturing the screen" << std::endl;
+                    return false;
+                }
+            }
+
+            if (image->bits_per_pixel != 32) {
+                std::cerr << "Error capturing the screen: " << image->bits_per_pixel << " bit displays are not supported" << std::endl;
+                return false;
+            }
+            frame = cv::Mat(image->height, image->width, CV_8UC4, image->data, image->bytes_per_line);
+            return true;
+        }
+
+    private:
+        bool createShmImage(cv::Size size) {
+            int screen = DefaultScreen(display);
+            image = XShmCreateImage(display, DefaultVisual(display, screen), DefaultDepth(display, screen), ZPixmap, nullptr,
+                &shmInfo, size.width, size.height);
+            if (image == nullptr) return false;
+
+            shmInfo.shmid = shmget(IPC_PRIVATE, static_cast<size_t>(image->bytes_per_line) * image->height, IPC_CREAT | 0600);
+            if (shmInfo.shmid < 0) {
+                XDestroyImage(image);
+                image = nullptr;
+                return false;
+            }
+            shmInfo.shmaddr = image->data = static_cast<char*>(shmat(shmInfo.shmid, nullptr, 0));
+            shmInfo.readOnly = False;
+            //the segment goes away once both sides have detached from it, even if the app does not exit cleanly
+            shmctl(shmInfo.shmid, IPC_RMID, nullptr);
+            if (shmInfo.shmaddr == reinterpret_cast<char*>(-1)) {
+                image->data = nullptr;
+                XDestroyImage(image);
+                image = nullptr;
+                return false;
+            }
+
+            shmAttachFailed = false;
+            XErrorHandler previousHandler = XSetErrorHandler(catchShmAttachError);
+            XShmAttach(display, &shmInfo);
+            XSync(display, False);
+            XSetErrorHandler(previousHandler);
+            if (shmAttachFailed) {
+                shmdt(shmInfo.shmaddr);
+                image->data = nullptr;
+                XDestroyImage(image);
+                image = nullptr;
+                return false;
+            }
+            shmAttached = true;
+            return true;
+        }
+
+        void releaseImage() {
+            if (image == nullptr) return;
+            if (shmAttached) {
+                XShmDetach(display, &shmInfo);
+                XSync(display, False);
+                shmdt(shmInfo.shmaddr);
+                //the pixels are the shared segment, XDestroyImage must not free them
+                image->data = nullptr;
+                shmAttached = false;
+            }
+            XDestroyImage(image);
+            image = nullptr;
+        }
+
+        Display* display = nullptr;
+        Window root = 0;
+        bool useShm = false;
+        bool shmAttached = false;
+        XShmSegmentInfo shmInfo = {};
+        XImage* image = nullptr;
+    };
+#endif
+}
+
+std::unique_ptr<ScreenCapture> ScreenCapture::create() {
+#if defined(_WIN32)
+    return std::make_unique<Win32ScreenCapture>();
+#elif defined(__linux__)
+    std::unique_ptr<X11ScreenCapture> capture = std::make_unique<X11ScreenCapture>();
+    if (!capture->open()) return nullptr;
+    return capture;
+#else
+    std::cerr << "Screen capture is not supported on this platform" << std::endl;
+    return nullptr;
+#endif
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <GL/gl3w.h>
+#include <opencv2/core.hpp>
+
+#include <TextureStreamer.hpp>
+
+// owns one GL texture per view or card and only uploads when the caller's content version for it changes,
+// so going back to a card that still has its texture costs no upload. the least recently shown textures are
+// deleted once there are more than maxTextures. textures are mipmapped so they can be shown zoomed out
+//
+// needs a current GL context for its whole lifetime
+class TextureManager {
+public:
+	explicit TextureManager(size_t maxTextures = 32);
+	~TextureManager();
+	TextureManager(const TextureManager&) = delete;
+	TextureManager& operator=(const TextureManager&) = delete;
+
+	// the texture for key holding image (RGBA), uploading it first if the texture does not have this version yet.
+	// 0 for an empty image
+	GLuint texture(const std::string& key, const cv::Mat& image, uint64_t version);
+	// same as texture(), but the pixels are copied into a pixel buffer on the worker pool and streamed to the texture,
+	// returns 0 until that has happened. falls back to texture() when no pixel buffer is free
+	GLuint streamTexture(const std::string& key, const cv::Mat& image, uint64_t version);
+	void release(const std::string& key);
+
+	// bytes uploaded since the last call
+	size_t takeUploadedBytes();
+
+private:
+	struct ViewTexture {
+		std::string key;
+		GLuint texture;
+		cv::Size size;
+		uint64_t version;
+		int streamTicket;
+		uint64_t streamVersion;
+	};
+
+	std::list<ViewTexture>::iterator findOrCreate(const std::string& key);
+	void dropStream(ViewTexture& viewTexture);
+
+	size_t maxTextures;
+	std::list<ViewTexture> textures; // most recently used first
+	std::unordered_map<std::string, std::list<ViewTexture>::iterator> texturesByKey;
+	size_t uploadedBytes = 0;
+	std::unique_ptr<TextureStreamer> streamer; // created by the first streamTexture()
+};
@@ -0,0 +1,112 @@
+#include "TextureManager.hpp"
+
+#include <algorithm>
+
+TextureManager::TextureManager(size_t maxTextures)
+    : maxTextures(std::max<size_t>(maxTextures, 1)) {
+}
+
+TextureManager::~TextureManager() {
+    for (ViewTexture& viewTexture : textures) {
+        dropStream(viewTexture);
+        glDeleteTextures(1, &viewTexture.texture);
+    }
+}
+
+std::list<TextureManager::ViewTexture>::iterator TextureManager::findOrCreate(const std::string& key) {
+    auto found = texturesByKey.find(key);
+    if (found != texturesByKey.end()) {
+        textures.splice(textures.begin(), textures, found->second);
+        return found->second;
+    }
+
+    GLuint newTexture;
+    glGenTextures(1, &newTexture);
+    glBindTexture(GL_TEXTURE_2D, newTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    textures.push_front({ key, newTexture, cv::Size(), 0, -1, 0 });
+    texturesByKey[key] = textures.begin();
+
+    while (textures.size() > maxTextures) {
+        dropStream(textures.back());
+        glDeleteTextures(1, &textures.back().texture);
+        texturesByKey.erase(textures.back().key);
+        textures.pop_back();
+    }
+    return textures.begin();
+}
+
+void TextureManager::dropStream(ViewTexture& viewTexture) {
+    if (viewTexture.streamTicket == -1) return;
+    streamer->abandon(viewTexture.streamTicket);
+    viewTexture.streamTicket = -1;
+}
+
+GLuint TextureManager::texture(const std::string& key, const cv::Mat& image, uint64_t version) {
+    if (image.empty()) return 0;
+    CV_Assert(image.type() == CV_8UC4);
+    std::list<ViewTexture>::iterator viewTexture = findOrCreate(key);
+    if (viewTexture->version == version && viewTexture->size == image.size()) {
+        return viewTexture->texture;
+    }
+    dropStream(*viewTexture);
+
+    glBindTexture(GL_TEXTURE_2D, viewTexture->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(image.step / image.elemSize()));
+    if (viewTexture->size != image.size()) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.cols, image.rows, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.data);
+        viewTexture->size = image.size();
+    }
+    else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.cols, image.rows, GL_RGBA, GL_UNSIGNED_BYTE, image.data);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    viewTexture->version = version;
+    uploadedBytes += image.total() * image.elemSize();
+    return viewTexture->texture;
+}
+
+GLuint TextureManager::streamTexture(const std::string& key, const cv::Mat& image, uint64_t version) {
+    if (image.empty()) return 0;
+    CV_Assert(image.type() == CV_8UC4);
+    std::list<ViewTexture>::iterator viewTexture = findOrCreate(key);
+    if (viewTexture->version == version && viewTexture->size == image.size()) {
+        return viewTexture->texture;
+    }
+
+    if (viewTexture->streamTicket != -1 && viewTexture->streamVersion != version) dropStream(*viewTexture);
+    if (viewTexture->streamTicket == -1) {
+        if (!streamer) streamer = std::make_unique<TextureStreamer>();
+        viewTexture->streamTicket = streamer->begin(image);
+        viewTexture->streamVersion = version;
+        if (viewTexture->streamTicket == -1) return texture(key, image, version);
+        return 0;
+    }
+    if (!streamer->copied(viewTexture->streamTicket)) return 0;
+
+    uploadedBytes += streamer->finish(viewTexture->streamTicket, viewTexture->texture, viewTexture->size != image.size());
+    glBindTexture(GL_TEXTURE_2D, viewTexture->texture);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    viewTexture->streamTicket = -1;
+    viewTexture->size = image.size();
+    viewTexture->version = version;
+    return viewTexture->texture;
+}
+
+void TextureManager::release(const std::string& key) {
+    auto found = texturesByKey.find(key);
+    if (found == texturesByKey.end()) return;
+    dropStream(*found->second);
+    glDeleteTextures(1, &found->second->texture);
+    textures.erase(found->second);
+    texturesByKey.erase(found);
+}
+
+size_t TextureManager::takeUploadedBytes() {
+    size_t bytes = uploadedBytes;
+    uploadedBytes = 0;
+    return bytes;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <future>
+#include <vector>
+
+#include <GL/gl3w.h>
+#include <opencv2/core.hpp>
+
+// ring of pixel unpack buffers that images are copied into on the worker pool, so the render thread only
+// issues the copy from a buffer into a texture and the driver does the transfer without stalling the frame.
+// with GL 4.4 the buffers stay persistently mapped, otherwise each one is mapped for the copy into it.
+// a buffer is reused once a fence shows the gpu has finished reading it.
+//
+// images arrive decoded rather than being decoded into a buffer: the same decoded card is kept by the image
+// cache and shown again without any decode, so the one copy into the buffer is done here on the pool instead
+//
+// begin, copied, finish and abandon are called from the render thread with a current GL context
+class TextureStreamer {
+public:
+	explicit TextureStreamer(size_t bufferCount = 3);
+	~TextureStreamer();
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	bool isPersistent() const { return persistent; }
+
+	// starts copying an RGBA image into a free buffer and returns its ticket, or -1 if every buffer is in use
+	int begin(const cv::Mat& image);
+	// true once the image for ticket is in its buffer
+	bool copied(int ticket);
+	// copies the buffer for ticket into texture, (re)allocating the texture's storage when allocate is set,
+	// and returns the number of bytes uploaded. only call once copied(ticket) is true
+	size_t finish(int ticket, GLuint texture, bool allocate);
+	// gives up on ticket without waiting, its buffer is reused once the copy into it has ended
+	void abandon(int ticket);
+
+private:
+	struct Buffer {
+		GLuint id = 0;
+		size_t capacity = 0;
+		unsigned char* mapped = nullptr;
+		std::future<void> copy;
+		cv::Size imageSize;
+		GLsync fence = nullptr;
+		bool busy = false;
+		bool abandoned = false;
+	};
+
+	bool reclaim(Buffer& buffer);
+	void unmap(Buffer& buffer);
+
+	bool persistent;
+	std::vector<Buffer> buffers;
+};
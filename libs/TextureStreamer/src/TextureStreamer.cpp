@@ -0,0 +1,143 @@
+#include "TextureStreamer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <WorkerPool.hpp>
+
+namespace {
+    //buffers grow in whole steps so cards of slightly different sizes reuse them
+    const size_t capacityStep = 1024 * 1024;
+    const GLbitfield persistentMapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+}
+
+TextureStreamer::TextureStreamer(size_t bufferCount)
+    : persistent(gl3wIsSupported(4, 4) != 0), buffers(std::max<size_t>(bufferCount, 1)) {
+}
+
+TextureStreamer::~TextureStreamer() {
+    for (Buffer& buffer : buffers) {
+        if (buffer.copy.valid()) buffer.copy.wait();
+        if (buffer.fence != nullptr) glDeleteSync(buffer.fence);
+        if (buffer.id != 0) {
+            unmap(buffer);
+            glDeleteBuffers(1, &buffer.id);
+        }
+    }
+}
+
+void TextureStreamer::unmap(Buffer& buffer) {
+    if (buffer.mapped == nullptr) return;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    buffer.mapped = nullptr;
+}
+
+bool TextureStreamer::reclaim(Buffer& buffer) {
+    if (!buffer.busy) return true;
+    if (buffer.abandoned) {
+        //nothing was uploaded from an abandoned buffer, it is free as soon as the copy into it is done
+        if (buffer.copy.valid() && buffer.copy.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+        buffer.copy = std::future<void>();
+        if (!persistent) unmap(buffer);
+        buffer.abandoned = false;
+        buffer.busy = false;
+        return true;
+    }
+    if (buffer.fence == nullptr) return false;
+    GLenum status = glClientWaitSync(buffer.fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return false;
+    glDeleteSync(buffer.fence);
+    buffer.fence = nullptr;
+    buffer.busy = false;
+    return true;
+}
+
+int TextureStreamer::begin(const cv::Mat& image) {
+    CV_Assert(image.type() == CV_8UC4);
+    int ticket = -1;
+    for (size_t i = 0; i < buffers.size() && ticket == -1; i++) {
+        if (reclaim(buffers[i])) ticket = static_cast<int>(i);
+    }
+    if (ticket == -1) return -1;
+
+    Buffer& buffer = buffers[ticket];
+    size_t bytes = image.total() * image.elemSize();
+    if (buffer.capacity < bytes) {
+        size_t capacity = (bytes + capacityStep - 1) / capacityStep * capacityStep;
+        if (persistent) {
+            //persistent storage is immutable, so growing it means a new buffer
+            if (buffer.id != 0) {
+                unmap(buffer);
+                glDeleteBuffers(1, &buffer.id);
+            }
+            glGenBuffers(1, &buffer.id);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+            glBufferStorage(GL_PIXEL_UNPACK_BUFFER, capacity, nullptr, persistentMapFlags);
+            buffer.mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, capacity, persistentMapFlags));
+        }
+        else {
+            if (buffer.id == 0) glGenBuffers(1, &buffer.id);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        buffer.capacity = capacity;
+    }
+    if (!persistent) {
+        //the fence has passed, so nothing is reading the buffer and it can be mapped without waiting
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+        buffer.mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    if (buffer.mapped == nullptr) {
+        std::cerr << "Error mapping texture upload buffer" << std::endl;
+        buffer.capacity = 0;
+        return -1;
+    }
+
+    unsigned char* destination = buffer.mapped;
+    buffer.imageSize = image.size();
+    buffer.busy = true;
+    buffer.copy = WorkerPool::shared().submit([image, destination]() {
+        size_t rowBytes = image.cols * image.elemSize();
+        for (int y = 0; y < image.rows; y++) {
+            std::memcpy(destination + y * rowBytes, image.ptr(y), rowBytes);
+        }
+    });
+    return ticket;
+}
+
+bool TextureStreamer::copied(int ticket) {
+    Buffer& buffer = buffers[ticket];
+    return buffer.copy.valid() && buffer.copy.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+size_t TextureStreamer::finish(int ticket, GLuint texture, bool allocate) {
+    Buffer& buffer = buffers[ticket];
+    buffer.copy.get();
+    if (!persistent) unmap(buffer);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    if (allocate) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, buffer.imageSize.width, buffer.imageSize.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, buffer.imageSize.width, buffer.imageSize.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    return buffer.imageSize.area() * 4;
+}
+
+void TextureStreamer::abandon(int ticket) {
+    buffers[ticket].abandoned = true;
+    reclaim(buffers[ticket]);
+}
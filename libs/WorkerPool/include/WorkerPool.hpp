@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of background threads shared by the flashcard store for scans and searches
+class WorkerPool {
+public:
+	explicit WorkerPool(unsigned threadCount = std::thread::hardware_concurrency());
+	~WorkerPool();
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	static WorkerPool& shared();
+
+	unsigned threadCount() const { return static_cast<unsigned>(threads.size()); }
+
+	template<typename F>
+	auto submit(F&& task) -> std::future<decltype(task())> {
+		auto packagedTask = std::make_shared<std::packaged_task<decltype(task())()>>(std::forward<F>(task));
+		std::future<decltype(task())> result = packagedTask->get_future();
+		enqueue([packagedTask]() { (*packagedTask)(); });
+		return result;
+	}
+
+	// runs body(0) .. body(count - 1) on the pool and the calling thread and returns when all of them have finished
+	// the caller takes items too, so this is safe to call from inside a pool task
+	// once cancelled is set the remaining items are skipped
+	void parallelFor(size_t count, const std::function<void(size_t)>& body, const std::atomic<bool>* cancelled = nullptr);
+
+	// called on the worker thread after each task has finished and its future is ready, e.g. to wake the ui loop
+	void setTaskFinishedCallback(std::function<void()> callback);
+
+private:
+	void enqueue(std::function<void()> task);
+	void workerLoop();
+
+	std::vector<std::thread> threads;
+	std::deque<std::function<void()>> tasks;
+	std::mutex tasksMutex;
+	std::condition_variable tasksAvailable;
+	std::function<void()> taskFinishedCallback;
+	bool stopping = false;
+};
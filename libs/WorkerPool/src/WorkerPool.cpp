@@ -0,0 +1,95 @@
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(unsigned threadCount) {
+    threadCount = std::max(1u, threadCount);
+    for (unsigned i = 0; i < threadCount; i++) {
+        threads.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        stopping = true;
+    }
+    tasksAvailable.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+WorkerPool& WorkerPool::shared() {
+    static WorkerPool pool;
+    return pool;
+}
+
+void WorkerPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        tasks.push_back(std::move(task));
+    }
+    tasksAvailable.notify_one();
+}
+
+void WorkerPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        std::function<void()> finishedCallback;
+        {
+            std::unique_lock<std::mutex> lock(tasksMutex);
+            tasksAvailable.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            finishedCallback = taskFinishedCallback;
+        }
+        task();
+        if (finishedCallback) finishedCallback();
+    }
+}
+
+void WorkerPool::setTaskFinishedCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(tasksMutex);
+    taskFinishedCallback = std::move(callback);
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& body, const std::atomic<bool>* cancelled) {
+    if (count == 0) return;
+
+    struct ParallelForState {
+        std::atomic<size_t> nextItem{ 0 };
+        size_t finishedItems = 0;
+        std::mutex finishedMutex;
+        std::condition_variable allFinished;
+    };
+    auto state = std::make_shared<ParallelForState>();
+
+    //body is only touched for items that were claimed, and the caller waits for every claimed item,
+    //so helpers that start after the loop is over never use the reference
+    auto work = [state, count, &body, cancelled]() {
+        size_t finished = 0;
+        for (size_t i = state->nextItem++; i < count; i = state->nextItem++) {
+            if (cancelled == nullptr || !cancelled->load()) {
+                body(i);
+            }
+            finished++;
+        }
+        if (finished == 0) return;
+        std::lock_guard<std::mutex> lock(state->finishedMutex);
+        state->finishedItems += finished;
+        if (state->finishedItems == count) {
+            state->allFinished.notify_all();
+        }
+    };
+
+    size_t helpers = std::min<size_t>(threads.size(), count - 1);
+    for (size_t i = 0; i < helpers; i++) {
+        enqueue(work);
+    }
+    work();
+
+    std::unique_lock<std::mutex> lock(state->finishedMutex);
+    state->allFinished.wait(lock, [&]() { return state->finishedItems == count; });
+}
@@ -1,7 +1,6 @@
 #include <iostream>
 #include <fstream>
 #include <cstdlib>
-#include <sys/stat.h>
 #include <filesystem>
 #include <opencv2/opencv.hpp>
 #include <opencv2/core/utils/logger.hpp>
@@ -12,210 +11,39 @@
 #include <GL/gl3w.h>
 #include <GLFW/glfw3.h>
 
-#include <windows.h>
-#include <wingdi.h>
-
 #include <json.h>
 #include <StrUtils.hpp>
 using namespace StrUtils;
-
+#include <CanvasTexture.hpp>
+#include <CanvasView.hpp>
+#include <CardText.hpp>
+#include <Clipboard.hpp>
+#include <FlashcardCatalog.hpp>
+#include <FlashcardImageCache.hpp>
+#include <FlashcardPack.hpp>
+#include <FlashcardPrefetcher.hpp>
+#include <FlashcardStore.hpp>
+#include <FrameProfiler.hpp>
+#include <GrowableCanvas.hpp>
+#include <PixelSwizzle.hpp>
+#include <ScreenCapture.hpp>
+#include <TextureManager.hpp>
+using namespace FlashcardStore;
+#include <WorkerPool.hpp>
+
+#include <atomic>
 #include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <thread>
 
-void copyFromClipboard(cv::Mat& mat) {
-    HBITMAP hbitmap = nullptr;
-    if (!::OpenClipboard(nullptr))
-        return;
-    if (IsClipboardFormatAvailable(CF_BITMAP))
-        hbitmap = (HBITMAP)GetClipboardData(CF_BITMAP);
-    if (!hbitmap && IsClipboardFormatAvailable(CF_DIB))
-    {
-        HANDLE handle = GetClipboardData(CF_DIB);
-        LPVOID hmem = GlobalLock(handle);
-        if (hmem)
-        {
-            BITMAPINFO* bmpinfo = (BITMAPINFO*)hmem;
-            int offset = (bmpinfo->bmiHeader.biBitCount > 8) ?
-                0 : sizeof(RGBQUAD) * (1 << bmpinfo->bmiHeader.biBitCount);
-            BYTE* bits = (BYTE*)(bmpinfo)+bmpinfo->bmiHeader.biSize + offset;
-            HDC hdc = ::GetDC(0);
-            hbitmap = CreateDIBitmap(hdc,
-                &bmpinfo->bmiHeader, CBM_INIT, bits, bmpinfo, DIB_RGB_COLORS);
-            ::ReleaseDC(0, hdc);
-            GlobalUnlock(hmem);
-        }
-    }
-
-    if (hbitmap)
-    {
-        BITMAP bm;
-        ::GetObject(hbitmap, sizeof(bm), &bm);
-        int cx = bm.bmWidth;
-        int cy = bm.bmHeight;
-        if (bm.bmBitsPixel == 32)
-        {
-            mat.create(cy, cx, CV_8UC4);
-            BITMAPINFOHEADER bi = { sizeof(bi), cx, -cy, 1, 32, BI_RGB };
-            HDC hdc = ::GetDC(0);
-            GetDIBits(hdc, hbitmap, 0, cy, mat.data, (BITMAPINFO*)&bi, DIB_RGB_COLORS);
-        }
-    }
-    CloseClipboard();
-}
-
-
-void multiLinePutText(cv::Mat img,
-    std::string text,
-    cv::Point pos,
-    int fontFace = cv::HersheyFonts::FONT_HERSHEY_SIMPLEX,
-    float fontScale = 0.5,
-    cv::Scalar color = cv::Scalar(0, 0, 0, 255),
-    int thickness = 1,    
-    float lineSpacing = 1.0)
-{
-    std::vector<std::string> lines = splitString(text, "\n");
-    for (std::string line : lines) {
-        int baseLine;
-        cv::Size textSize = cv::getTextSize(line, fontFace, fontScale, thickness, &baseLine);
-        cv::putText(img, line, pos, fontFace, fontScale, color, thickness);
-        pos += cv::Point(0, textSize.height * lineSpacing);
-    }
-}
-
-//make a file name for saving the flashcard
-void makeFileName(char* fileName) {    
-    time_t t = time(0);
-    struct tm* now = localtime(&t);
-    strftime(fileName, 128, "Flashcard-%Y-%m-%d-%H-%M-%S", now);
-}
-
-std::vector<std::string> getAllTopics() {
-    std::vector<std::string> listOfTopics;
-    return listOfTopics;
-}
-
-std::vector<std::string> searchForFlashcards(std::string directory, std::string topic, std::vector<std::string> keywords) {
-    std::vector<std::string> flashcardFilenames;
-    // check if directory/topic is a valid directory
-    // open each json file found in the directory
-    // itterate through the keywords found in the json file
-    // if all the keywords listed in keywords are found, then add the name of the file to flashcardFilenames
-    struct stat sb;
-    std::string flashcardDirectoryStr = std::string(directory + "/" + topic);
-    const char* flashcardDirectory = flashcardDirectoryStr.c_str();
-    if (stat(flashcardDirectory, &sb) == 0) {
-        for (const auto& dirEntry : std::filesystem::directory_iterator(flashcardDirectory)) {
-            if (dirEntry.path().extension() == ".json") {
-                Json::Value root;
-                std::ifstream ifs;
-                ifs.open(dirEntry);
-
-                Json::CharReaderBuilder builder;
-                builder["collectComments"] = true;
-                JSONCPP_STRING errs;
-                if (!parseFromStream(builder, ifs, &root, &errs)) {
-                    return flashcardFilenames;
-                    std::cerr << errs << std::endl;
-                }
-
-                std::cout << root << std::endl;
-
-                std::vector<std::string> flashcardKeywords;
-                if (root.isMember("keywords")) {
-                    for (auto flashcardKeyword : root["keywords"]) {
-                        flashcardKeywords.push_back(flashcardKeyword.asString());
-                    }
-                }
-
-                //check if all the keywords being searched for are found in this flashcard
-                bool allKeywordsFound = true;
-                for (auto keyword : keywords) {
-                    if (keyword.empty()) continue;
-                    if (std::find(flashcardKeywords.begin(), flashcardKeywords.end(), keyword) == flashcardKeywords.end()) {
-                        allKeywordsFound = false;
-                    }
-                }
-                if (!allKeywordsFound) {
-                    continue;
-                }
-
-                flashcardFilenames.push_back(dirEntry.path().filename().stem().string());
-
-                std::vector<std::pair<cv::Point, cv::Point>> answerBoxPositions;
-                if (root.isMember("answerBoxPositionsList")) {
-                    for (auto boxBounds : root["answerBoxPositionsList"]) {
-                        cv::Point boxPosition(boxBounds[0][0].asInt(), boxBounds[0][1].asInt());
-                        cv::Point boxEndPosition(boxBounds[1][0].asInt(), boxBounds[1][1].asInt());
-                        std::pair<cv::Point, cv::Point> boxBounds(boxPosition, boxEndPosition);
-                        answerBoxPositions.push_back(boxBounds);
-                    }
-                }
-
-                std::vector<std::pair<cv::Point, cv::Point>> questionBoxPositions;
-                if (root.isMember("questionBoxPositionsList")) {
-                    for (auto boxBounds : root["answerBoxPositionsList"]) {
-                        cv::Point boxPosition(boxBounds[0][0].asInt(), boxBounds[0][1].asInt());
-                        cv::Point boxEndPosition(boxBounds[1][0].asInt(), boxBounds[1][1].asInt());
-                        std::pair<cv::Point, cv::Point> boxBounds(boxPosition, boxEndPosition);
-                        questionBoxPositions.push_back(boxBounds);
-                    }
-                }
-            }            
-        }
-    }
-    else {
-        std::cerr << "Error searching for flashcards:" << std::endl;
-        std::cerr << "Folder with name: " << topic << " not found." << std::endl;
-    }
-    
-    return flashcardFilenames;
-}
-
-cv::Mat loadFlashcardImage(std::string flashcardSavePath, std::string topic, std::string fileName) {
-    //cv imread needs an absolute path to read the image
-    std::filesystem::path fnPath(flashcardSavePath + "/" + topic + "/" + fileName + ".png");
-    std::string fnPathStr = std::filesystem::absolute(fnPath).string();
-    cv::Mat img = cv::imread(fnPathStr);
-    if (!img.empty()) {
-        cv::cvtColor(img, img, cv::COLOR_BGR2RGBA);    }
-    
-    return img;
-}
-
-void loadFlashcardBoxBounds(std::string flashcardSavePath, std::string topic, std::string fileName,
-    std::vector<std::pair<cv::Point, cv::Point>> &answerBoxBounds,
-    std::vector<std::pair<cv::Point, cv::Point>> &questionBoxBounds) {
-
-    Json::Value root;
-    std::ifstream ifs;
-    ifs.open(flashcardSavePath + "/" + topic + "/" + fileName + ".json");
-
-    Json::CharReaderBuilder builder;
-    builder["collectComments"] = true;
-    JSONCPP_STRING errs;
-    if (!parseFromStream(builder, ifs, &root, &errs)) {
-        std::cerr << errs << std::endl;
-        return;        
-    }
-
-    if (root.isMember("answerBoxPositionsList")) {
-        for (auto boxBounds : root["answerBoxPositionsList"]) {
-            cv::Point boxPosition(boxBounds[0][0].asInt(), boxBounds[0][1].asInt());
-            cv::Point boxEndPosition(boxBounds[1][0].asInt(), boxBounds[1][1].asInt());
-            std::pair<cv::Point, cv::Point> boxBounds(boxPosition, boxEndPosition);
-            answerBoxBounds.push_back(boxBounds);
-        }
-    }
-
-    if (root.isMember("questionBoxPositionsList")) {
-        for (auto boxBounds : root["questionBoxPositionsList"]) {
-            cv::Point boxPosition(boxBounds[0][0].asInt(), boxBounds[0][1].asInt());
-            cv::Point boxEndPosition(boxBounds[1][0].asInt(), boxBounds[1][1].asInt());
-            std::pair<cv::Point, cv::Point> boxBounds(boxPosition, boxEndPosition);
-            questionBoxBounds.push_back(boxBounds);
-        }
-    }
-}
+//last, the native header pulls in Xlib and its macros
+#if defined(__linux__)
+#define GLFW_EXPOSE_NATIVE_X11
+#include <GLFW/glfw3native.h>
+#endif
 
 bool topicsFilterCallbackCalled = false;
 int topicsFilterCallback(ImGuiInputTextCallbackData* data) {
@@ -229,37 +57,6 @@ int keywordsFilterCallback(ImGuiInputTextCallbackData* data) {
     return 0;
 }
 
-void GetScreenShot(void) {
-    int x1, y1, x2, y2, w, h;
-
-    // get screen dimensions
-    x1 = GetSystemMetrics(SM_XVIRTUALSCREEN);
-    y1 = GetSystemMetrics(SM_YVIRTUALSCREEN);
-    x2 = GetSystemMetrics(SM_CXVIRTUALSCREEN);
-    y2 = GetSystemMetrics(SM_CYVIRTUALSCREEN);
-    w = x2 - x1;
-    h = y2 - y1;
-
-    // copy screen to bitmap
-    HDC     hScreen = GetDC(NULL);
-    HDC     hDC = CreateCompatibleDC(hScreen);
-    HBITMAP hBitmap = CreateCompatibleBitmap(hScreen, w, h);
-    HGDIOBJ old_obj = SelectObject(hDC, hBitmap);
-    BOOL    bRet = BitBlt(hDC, 0, 0, w, h, hScreen, x1, y1, SRCCOPY);
-
-    // save bitmap to clipboard
-    OpenClipboard(NULL);
-    EmptyClipboard();
-    SetClipboardData(CF_BITMAP, hBitmap);
-    CloseClipboard();
-
-    // clean up
-    SelectObject(hDC, old_obj);
-    DeleteDC(hDC);
-    ReleaseDC(NULL, hScreen);
-    DeleteObject(hBitmap);
-}
-
 int main( int argc, char* argv[] ) {
     cv::utils::logging::setLogLevel(cv::utils::logging::LogLevel::LOG_LEVEL_SILENT);
 
@@ -287,29 +84,80 @@ int main( int argc, char* argv[] ) {
         return -1;
     }
     ifs.close();
+
+    //pack every topic folder into a single file deck and exit
+    if (argc > 1 && argv[1][0] == 'p') {
+        std::string flashcardSavePath = configRoot["flashcardSavePath"].asString();
+        for (const auto& dirEntry : std::filesystem::directory_iterator(flashcardSavePath)) {
+            if (!dirEntry.is_directory()) continue;
+            std::string topic = dirEntry.path().filename().string();
+            if (FlashcardPack::convertTopicToPack(flashcardSavePath, topic, true)) {
+                std::cout << "Packed topic: " << topic << std::endl;
+            }
+        }
+        return 0;
+    }
+
+    //export every card as a PNG, for viewers that can not open the QOI images cards may be saved as
+    if (argc > 1 && argv[1][0] == 'e') {
+        std::string flashcardSavePath = configRoot["flashcardSavePath"].asString();
+        std::string exportPath = argc > 2 ? argv[2] : flashcardSavePath + "-png";
+        for (const std::string& topic : getAllTopics(flashcardSavePath)) {
+            size_t exported = exportTopicAsPng(flashcardSavePath, topic, exportPath);
+            std::cout << "Exported " << exported << " flashcard(s) of topic: " << topic << std::endl;
+        }
+        return 0;
+    }
+
+    //decoded card images are kept in memory up to this many bytes
+    FlashcardImageCache::shared().setByteBudget(static_cast<size_t>(configRoot.get("imageCacheBytes", 268435456).asUInt64()));
+
+    //card images are saved as flashcardImageFormat, cards are read back in whichever format they were saved in
+    ImageFormat flashcardImageFormat = imageFormatFromName(configRoot.get("flashcardImageFormat", "png").asString());
+
+    //flashcard saves run in the background, the config of the newest save is the one kept
+    static SaveQueue saveQueue;
+    static std::mutex configFileMutex;
+    static unsigned configVersionsSaved = 0;
+    static unsigned configVersionWritten = 0;
+    static std::string saveStatus;
+    //writes a snapshot of the app configuration, never replacing the snapshot of a later change
+    auto writeConfig = [envConfigPath](const Json::Value& configSnapshot, unsigned configVersion) {
+        std::lock_guard<std::mutex> lock(configFileMutex);
+        if (configVersion > configVersionWritten) {
+            std::ofstream configFile(envConfigPath);
+            Json::StreamWriterBuilder builder;
+            const std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+            writer->write(configSnapshot, &configFile);
+            configFile.close();
+            configVersionWritten = configVersion;
+        }
+    };
     
     char fileName[128];
     makeFileName(fileName);
 
     cv::Mat image = cv::Mat(400, 800, CV_8UC4, cv::Scalar(255, 255, 255, 255));
     cv::Mat imageFromClipboard;
+    //the clipboard's image is decoded once per copy, not once per paste
+    std::unique_ptr<Clipboard> clipboard = Clipboard::create();
 
     static bool takeScreenshot = true;
     if (argc > 1 && argv[1][0] == 's') {
         takeScreenshot = false;
     }
-    else  if (argc > 1 && argv[1][0] == 'c') {
-        copyFromClipboard(imageFromClipboard);
+    else  if (argc > 1 && argv[1][0] == 'c' && clipboard) {
+        imageFromClipboard = clipboard->image();
         if (!imageFromClipboard.empty()) {
             cv::Size cs = imageFromClipboard.size() + cv::Size(200, 200);
             image = cv::Mat(cs.height, cs.width, CV_8UC4, cv::Scalar(255, 255, 255, 255));
             imageFromClipboard.copyTo(image(cv::Rect(100, 100, imageFromClipboard.cols, imageFromClipboard.rows)));
         }
     }    
-    cv::cvtColor(image, image, cv::COLOR_BGR2RGBA);
-    cv::Mat canvasMat;
+    //the canvas takes over the start image, it would copy it on the first edit if image still shared it
+    GrowableCanvas canvas(image);
+    image.release();
     cv::Mat currentFlashcardImage = cv::Mat(400, 800, CV_8UC4, cv::Scalar(255, 255, 255, 255));
-    cv::Mat currentFlashcardCanvas;
 
     //buffers
     static char textBuffer[1000*1000] = "";    
@@ -329,14 +177,35 @@ int main( int argc, char* argv[] ) {
         }
         strncpy(keywordsBuffer, keywordsStr.c_str(), keywordsStr.length());
     }
+    //the screen region Capture Region grabs, chosen by cropping a screenshot
+    static cv::Rect screenshotRegion;
+    if (configRoot.isMember("screenshotRegion") && configRoot["screenshotRegion"].size() == 4) {
+        const Json::Value& region = configRoot["screenshotRegion"];
+        screenshotRegion = cv::Rect(region[0].asInt(), region[1].asInt(), region[2].asInt(), region[3].asInt());
+    }
 
 
     if( !glfwInit() ){
         return -1;
     }
 
+    //keep the topic indexes up to date as cards are added or removed outside the app
+    static std::atomic<bool> catalogChanged{ false };
+    static FlashcardCatalog catalog(configRoot["flashcardSavePath"].asString());
+    catalog.setChangeCallback([]() {
+        catalogChanged = true;
+        glfwPostEmptyEvent();
+    });
+    catalog.start();
+
+    //searches, prefetches and saves wake the ui loop when they finish
+    WorkerPool::shared().setTaskFinishedCallback([]() { glfwPostEmptyEvent(); });
+
     GLFWwindow* window = glfwCreateWindow( 1920, 1080, "Flashcards", nullptr, nullptr );
     glfwSetWindowPos(window, 0, 0);
+#if defined(__linux__)
+    if (clipboard) clipboard->setOwnWindow(glfwGetX11Window(window));
+#endif
     
     glfwSetWindowCloseCallback( window, []( GLFWwindow* window ){ glfwSetWindowShouldClose( window, GL_FALSE ); } );
     glfwMakeContextCurrent( window );
@@ -351,29 +220,87 @@ int main( int argc, char* argv[] ) {
 
     //apply ImGui configurations
     ImGui::GetIO().ConfigWindowsMoveFromTitleBarOnly = true;
-    int font = cv::FONT_HERSHEY_COMPLEX;
 
-    GLuint texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    //card text comes from its own font in the ImGui atlas, rasterized 1:1 so Apply Text can copy its glyphs
+    ImGui::GetIO().Fonts->AddFontDefault();
+    ImFontConfig cardFontConfig;
+    cardFontConfig.SizePixels = 20.0f;
+    cardFontConfig.OversampleH = 1;
+    cardFontConfig.OversampleV = 1;
+    cardFontConfig.PixelSnapH = true;
+    CardText cardText(ImGui::GetIO().Fonts->AddFontDefault(&cardFontConfig));
+
+    //the editor canvas only uploads what changed on the card, presented cards only when first shown
+    //everything drawn over the canvas is a draw list primitive or a small overlay texture
+    std::unique_ptr<CanvasTexture> canvasTexture = std::make_unique<CanvasTexture>();
+    std::unique_ptr<TextureManager> cardTextures = std::make_unique<TextureManager>();
+    std::unique_ptr<TextureManager> overlayTextures = std::make_unique<TextureManager>();
+    static uint64_t pastePreviewVersion = 0;
+
+    //screenshots are grabbed straight off the screen, without going through the clipboard
+    std::unique_ptr<ScreenCapture> screenCapture = ScreenCapture::create();
+    static double frameMilliseconds = 0.0;
+    static size_t frameUploadedBytes = 0;
+    static size_t lastFrameUploadedBytes = 0;
+
+    //the loop sleeps until input or finished background work wakes it, then draws a few frames so ImGui can
+    //settle hover and click states and edits made after their widget was drawn show up
+    //anything that changes without an event asks for frames with keepDrawing or wakeWithin
+    const int framesAfterWake = 3;
+    int framesToDraw = framesAfterWake;
+    double wakeTimeout = -1.0;
+    auto keepDrawing = [&]() { framesToDraw = std::max(framesToDraw, 1); };
+    auto wakeWithin = [&](double seconds) { wakeTimeout = wakeTimeout < 0.0 ? seconds : std::min(wakeTimeout, seconds); };
+
+    //per stage frame timings, shown with F3
+    FrameProfiler profiler;
+    profiler.dumpPath = configRoot.get("frameProfilePath", "frameProfile.csv").asString();
+    bool showProfiler = false;
 
     bool is_show = true;
     while( is_show ){
-        glfwPollEvents();
+        if (framesToDraw > 0) {
+            framesToDraw--;
+            profiler.beginFrame();
+            FrameProfiler::Scope eventsScope(profiler, "events");
+            glfwPollEvents();
+        }
+        else {
+            if (wakeTimeout >= 0.0) glfwWaitEventsTimeout(wakeTimeout);
+            else glfwWaitEvents();
+            framesToDraw = framesAfterWake - 1;
+            profiler.beginFrame();
+        }
+        wakeTimeout = -1.0;
+
+        //frames are timed from waking up, so time spent asleep does not count
+        std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+        lastFrameUploadedBytes = frameUploadedBytes;
+        frameUploadedBytes = 0;
         glClearColor( 0.0f, 0.0f, 0.0f, 1.0f );
         glClear( GL_COLOR_BUFFER_BIT );
 
+        FrameProfiler::Scope newFrameScope(profiler, "new frame");
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
+        newFrameScope.stop();
+        if (ImGui::IsKeyPressed(GLFW_KEY_F3, false)) showProfiler = !showProfiler;
 
+        FrameProfiler::Scope editorScope(profiler, "editor");
         ImGui::Begin("Create flashcard", &is_show);
 
-        image.copyTo(canvasMat);
-
+        //the mouse is mapped to card pixels through last frame's view, the view is laid out again where the card is drawn
+        static CanvasView canvasView;
+        ImVec2 maxCanvasViewSize(ImGui::GetIO().DisplaySize.x * 0.8f, ImGui::GetIO().DisplaySize.y * 0.6f);
+        static bool canvasViewFitted = false;
+        if (!canvasViewFitted) {
+            canvasView.fit(canvas.size(), maxCanvasViewSize);
+            canvasViewFitted = true;
+        }
         ImVec2 mousePos = ImGui::GetIO().MousePos;
-        ImVec2 pos = ImGui::GetCursorScreenPos();
-        ImVec2 canvasOffset(0.0f, 0.0f);
+        cv::Point mouseOnCanvas = canvasView.toImage(mousePos);
+        bool mouseOverCanvas = canvasView.contains(mousePos);
 
         static int addMode = 0;
 
@@ -384,18 +311,34 @@ int main( int argc, char* argv[] ) {
         static int imagePlacementDirectionY = 1;        
         static cv::Point2f textPosition;
 
+        //boxes are kept relative to the canvas origin so they stay on their pixels as the canvas grows or is cropped
         static cv::Point boxPosition(0, 0);
         static std::vector<std::pair<cv::Point, cv::Point>> answerBoxPositions;
         static std::vector<std::pair<cv::Point, cv::Point>> questionBoxPositions;
 
-        int imageShiftAmountX = 0;
-        int imageShiftAmountY = 0;
+        //while the canvas holds a screenshot, the screen position of its origin, so a crop can be mapped back to the screen
+        static bool canvasFromScreen = false;
+        static cv::Point screenshotScreenPos;
+
+        //overlays are drawn over the canvas once its image has been laid out, in canvas coordinates
+        std::vector<std::function<void(ImDrawList*, const CanvasView&)>> canvasOverlays;
+        auto addTextOverlay = [&](const std::string& text, cv::Point textPos) {
+            canvasOverlays.push_back([&cardText, text, textPos](ImDrawList* drawList, const CanvasView& view) {
+                cardText.draw(drawList, view.toScreen(textPos), text, IM_COL32(0, 0, 255, 255), view.zoom());
+            });
+        };
+        auto addBoxOverlay = [&](cv::Point corner1, cv::Point corner2, ImU32 color) {
+            canvasOverlays.push_back([corner1, corner2, color](ImDrawList* drawList, const CanvasView& view) {
+                drawList->AddRect(view.toScreen(cv::Point2f(std::min(corner1.x, corner2.x), std::min(corner1.y, corner2.y))),
+                    view.toScreen(cv::Point2f(std::max(corner1.x, corner2.x) + 1, std::max(corner1.y, corner2.y) + 1)),
+                    color, 0.0f, ImDrawCornerFlags_All, 2.0f);
+            });
+        };
 
         ImGuiIO io = ImGui::GetIO();
 
         if (addMode == 0 && !textPlaced && !imagePlaced) {
-            if ((mousePos.x - pos.x - canvasOffset.x > 0 && mousePos.x - pos.x - canvasOffset.x < canvasMat.cols) &&
-                (mousePos.y - pos.y - canvasOffset.y > 0 && mousePos.y - pos.y - canvasOffset.y < canvasMat.rows)) {
+            if (mouseOverCanvas) {
 
                 cv::String str = "Add text or image here\nYou may paste";
 
@@ -416,12 +359,18 @@ int main( int argc, char* argv[] ) {
                 //down arrow
                 else if (io.KeysDown[264]) imagePlacementDirectionY = 1;
 
-                //check if ctrl+v is being pressed
+                //check if ctrl+v is being pressed, the clipboard is only read when it is first pressed
                 static bool ctrlVPressed = false;
-                if (io.KeysDown[341] && io.KeysDown[86]) ctrlVPressed = true;
+                static bool ctrlVDown = false;
+                bool ctrlVDownNow = io.KeysDown[341] && io.KeysDown[86];
+                if (ctrlVDownNow && !ctrlVDown && clipboard) {
+                    imageFromClipboard = clipboard->image();
+                    pastePreviewVersion = clipboard->imageVersion();
+                }
+                ctrlVDown = ctrlVDownNow;
+                if (ctrlVDownNow) ctrlVPressed = true;
 
                 if (ctrlVPressed) {
-                    copyFromClipboard(imageFromClipboard);
                     if (imageFromClipboard.empty()) {
                         const char* ts = ImGui::GetClipboardText();
                         if (ts != nullptr) {
@@ -430,44 +379,21 @@ int main( int argc, char* argv[] ) {
                         }
                     }
                     else {
-                        cv::Point topLeftImagePos(mousePos.x - pos.x, mousePos.y - pos.y);
-                        cv::Point bottomRightImagePos = topLeftImagePos + cv::Point(imageFromClipboard.cols, imageFromClipboard.rows);
+                        cv::Point topLeftImagePos = mouseOnCanvas;
                         if (imagePlacementDirectionX == -1) {
                             topLeftImagePos.x -= imageFromClipboard.cols;
-                            bottomRightImagePos.x -= imageFromClipboard.cols;
                         }
                         if (imagePlacementDirectionY == -1) {
                             topLeftImagePos.y -= imageFromClipboard.rows;
-                            bottomRightImagePos.y -= imageFromClipboard.rows;
                         }
 
-                        cv::Point topLeftCutoffPoint(0, 0);
-                        cv::Point bottomRightCutoffPoint(imageFromClipboard.cols, imageFromClipboard.rows);
-
-                        if (bottomRightImagePos.x > canvasMat.cols) {
-                            bottomRightCutoffPoint.x -= bottomRightImagePos.x - canvasMat.cols;
-                            bottomRightImagePos.x = canvasMat.cols;
-                        }
-                        if (bottomRightImagePos.y > canvasMat.rows) {
-                            bottomRightCutoffPoint.y -= bottomRightImagePos.y - canvasMat.rows;
-                            bottomRightImagePos.y = canvasMat.rows;
-                        }
-                        if (topLeftImagePos.x < 0) {
-                            topLeftCutoffPoint.x = -topLeftImagePos.x;
-                            topLeftImagePos.x = 0;
-                        }
-                        if (topLeftImagePos.y < 0) {
-                            topLeftCutoffPoint.y = -topLeftImagePos.y;
-                            topLeftImagePos.y = 0;
-                        }
-                        int pasteImageRecLimitY = imageFromClipboard.rows;
-                        if (pasteImageRecLimitY + mousePos.y - pos.y > canvasMat.rows) {
-                            pasteImageRecLimitY = canvasMat.rows - (mousePos.y - pos.y);
-                        }
-                        cv::Rect visibleImagePortionRec(topLeftCutoffPoint, bottomRightCutoffPoint);
-                        cv::Mat visibleImagePortion = imageFromClipboard(visibleImagePortionRec);
-                        cv::Rect pasteImageRec(topLeftImagePos, bottomRightImagePos);
-                        visibleImagePortion.copyTo(canvasMat(pasteImageRec));
+                        //the preview is uploaded once per paste, the canvas clip rect cuts off what hangs over the edge
+                        canvasOverlays.push_back([&overlayTextures, &imageFromClipboard, topLeftImagePos](ImDrawList* drawList, const CanvasView& view) {
+                            GLuint pasteTexture = overlayTextures->streamTexture("paste-preview", imageFromClipboard, pastePreviewVersion);
+                            if (pasteTexture == 0) return;
+                            drawList->AddImage(reinterpret_cast<void*>(static_cast<intptr_t>(pasteTexture)), view.toScreen(topLeftImagePos),
+                                view.toScreen(topLeftImagePos + cv::Point(imageFromClipboard.cols, imageFromClipboard.rows)));
+                        });
 
                         if (ImGui::IsMouseDown(0)) {
                             imagePlaced = true;
@@ -475,17 +401,17 @@ int main( int argc, char* argv[] ) {
                         }
                     }
                 } else if (textBuffer[0] == 0) {
-                    multiLinePutText(canvasMat, str, cv::Point(mousePos.x - pos.x, mousePos.y - pos.y), font, 0.5, cv::Scalar(0, 0, 255, 255));
+                    addTextOverlay(str, mouseOnCanvas);
                 }
                 else {
-                    multiLinePutText(canvasMat, textBuffer, cv::Point(mousePos.x - pos.x, mousePos.y - pos.y), font, 0.5, cv::Scalar(0, 0, 255, 255));
+                    addTextOverlay(textBuffer, mouseOnCanvas);
                 }
                 
                 if (ImGui::IsMouseClicked(0)) {
                     if (!imagePlaced) {
                         textPlaced = true;
                         textBoxFocused = false;
-                        textPosition = cv::Point(mousePos.x - pos.x, mousePos.y - pos.y);
+                        textPosition = mouseOnCanvas;
                     }
                 }
             }
@@ -495,6 +421,7 @@ int main( int argc, char* argv[] ) {
 
             static int focusOnTextboxN = 0;
             if (!textBoxFocused) {
+                keepDrawing();
                 ImGui::SetKeyboardFocusHere();
                 ImGui::InputTextMultiline("Text", textBuffer, IM_ARRAYSIZE(textBuffer), ImVec2(400, ImGui::GetTextLineHeight() * 3));
                 focusOnTextboxN++;
@@ -508,69 +435,40 @@ int main( int argc, char* argv[] ) {
             }
             bool applyTextButton = ImGui::Button("Apply Text");
             if (applyTextButton) {
-                multiLinePutText(image, cv::String(textBuffer), textPosition, font, 0.5, cv::Scalar(0, 0, 255, 255));
+                cv::Mat canvasImage = canvas.writableImage();
+                canvasTexture->markDirty(cardText.rasterize(canvasImage, textPosition, textBuffer, cv::Scalar(0, 0, 255, 255)));
                 textPlaced = false;
                 textBoxFocused = false;
                 textBuffer[0] = 0;
             }
             
             if (textBuffer[0] == 0 && !applyTextButton) {
-                cv::putText(canvasMat, "Insert text here", textPosition, font, 0.5, cv::Scalar(0, 0, 255, 255));
+                addTextOverlay("Insert text here", textPosition);
             }
-            else {
-                multiLinePutText(canvasMat, cv::String(textBuffer), textPosition, font, 0.5, cv::Scalar(0, 0, 255, 255));
+            else if (!applyTextButton) {
+                addTextOverlay(textBuffer, textPosition);
             }
         }
         else if (addMode == 0 && imagePlaced) {
             imagePlaced = false;
-            cv::Point topLeftImagePos(mousePos.x - pos.x, mousePos.y - pos.y);
-            cv::Point bottomRightImagePos = topLeftImagePos + cv::Point(imageFromClipboard.cols, imageFromClipboard.rows);
+            cv::Point topLeftImagePos = mouseOnCanvas;
             if (imagePlacementDirectionX == -1) {
                 topLeftImagePos.x -= imageFromClipboard.cols;
-                bottomRightImagePos.x -= imageFromClipboard.cols;
             }
             if (imagePlacementDirectionY == -1) {
                 topLeftImagePos.y -= imageFromClipboard.rows;
-                bottomRightImagePos.y -= imageFromClipboard.rows;
-            }
-
-            bool canvasResizedRight = true;
-            bool canvasResizedDown = true;
-            int canvasResizeAmountX = 0;
-            int canvasResizeAmountY = 0;
-            if (bottomRightImagePos.x > canvasMat.cols) {
-                canvasResizeAmountX = bottomRightImagePos.x - canvasMat.cols;
-                canvasResizedRight = true;
-            }
-            if (bottomRightImagePos.y > canvasMat.rows) {
-                canvasResizeAmountY = bottomRightImagePos.y - canvasMat.rows;
-                canvasResizedDown = true;
-            }
-            if (topLeftImagePos.x < 0) {
-                canvasResizeAmountX = -topLeftImagePos.x;
-                topLeftImagePos.x = 0;
-                canvasResizedRight = false;
-            }
-            if (topLeftImagePos.y < 0) {
-                canvasResizeAmountY = -topLeftImagePos.y;
-                topLeftImagePos.y = 0;
-                canvasResizedDown = false;
             }
 
-            cv::Mat resizedCanvas(image.rows + canvasResizeAmountY, image.cols + canvasResizeAmountX, CV_8UC4, cv::Scalar(255, 255, 255, 255));
-            if (!canvasResizedRight && canvasResizedDown) {
-                imageShiftAmountX = canvasResizeAmountX;
-            }
-            else if (canvasResizedRight && !canvasResizedDown) {
-                imageShiftAmountY = canvasResizeAmountY;
+            //growing the canvas up or left moves everything on it, otherwise only the pasted region changes
+            cv::Size canvasSize = canvas.size();
+            cv::Point canvasOrigin = canvas.origin();
+            cv::Rect pastedRegion = canvas.paste(imageFromClipboard, topLeftImagePos);
+            if (canvas.size() != canvasSize || canvas.origin() != canvasOrigin) {
+                canvasTexture->markAllDirty();
             }
-            else if (!canvasResizedRight && !canvasResizedDown) {
-                imageShiftAmountX = canvasResizeAmountX;
-                imageShiftAmountY = canvasResizeAmountY;
+            else {
+                canvasTexture->markDirty(pastedRegion);
             }
-            image.copyTo(resizedCanvas(cv::Rect(imageShiftAmountX, imageShiftAmountY, image.cols, image.rows)));
-            imageFromClipboard.copyTo(resizedCanvas(cv::Rect(topLeftImagePos.x, topLeftImagePos.y, imageFromClipboard.cols, imageFromClipboard.rows)));
-            image = resizedCanvas;
         }
         else if (textPlaced) {
             textPlaced = false;
@@ -579,23 +477,22 @@ int main( int argc, char* argv[] ) {
             imagePlaced = false;
         }
         else if (addMode == 1 || addMode == 2 || addMode == 3) {
-            if ((mousePos.x - pos.x - canvasOffset.x > 0 && mousePos.x - pos.x - canvasOffset.x < canvasMat.cols) &&
-                (mousePos.y - pos.y - canvasOffset.y > 0 && mousePos.y - pos.y - canvasOffset.y < canvasMat.rows)) {
+            if (mouseOverCanvas) {
 
                 if (ImGui::IsMouseDown(0)) {
                     if (boxPosition == cv::Point(0, 0)) {
-                        boxPosition = cv::Point(mousePos.x - pos.x - canvasOffset.x, mousePos.y - pos.y - canvasOffset.y);
+                        boxPosition = mouseOnCanvas;
                     }
                     else {
-                        cv::Point boxEndPosition(mousePos.x - pos.x - canvasOffset.x, mousePos.y - pos.y - canvasOffset.y);
-                        cv::rectangle(canvasMat, boxPosition, boxEndPosition, cv::Scalar(100 * addMode, 0, 0, 255), 2);
+                        cv::Point boxEndPosition = mouseOnCanvas;
+                        addBoxOverlay(boxPosition, boxEndPosition, IM_COL32(std::min(100 * addMode, 255), 0, 0, 255));
                     }
                 }
                 else {
                     if (boxPosition != cv::Point(0, 0)) {
-                        cv::Point boxEndPosition(mousePos.x - pos.x - canvasOffset.x, mousePos.y - pos.y - canvasOffset.y);
+                        cv::Point boxEndPosition = mouseOnCanvas;
 
-                        std::pair<cv::Point, cv::Point> boxBounds(boxPosition, boxEndPosition);
+                        std::pair<cv::Point, cv::Point> boxBounds(boxPosition - canvas.origin(), boxEndPosition - canvas.origin());
                         if (addMode == 1) {
                             answerBoxPositions.push_back(boxBounds);
                         }
@@ -603,8 +500,19 @@ int main( int argc, char* argv[] ) {
                             questionBoxPositions.push_back(boxBounds);
                         }
                         else if (addMode == 3) {
-                            cv::Rect cropRect(cv::Rect(boxPosition, boxEndPosition));
-                            image = image(cropRect);
+                            cv::Rect cropRect = cv::Rect(boxPosition, boxEndPosition) & cv::Rect(cv::Point(0, 0), canvas.size());
+                            if (canvasFromScreen && !cropRect.empty()) {
+                                screenshotRegion = cropRect - canvas.origin() + screenshotScreenPos;
+                                configRoot["screenshotRegion"] = Json::arrayValue;
+                                configRoot["screenshotRegion"].append(screenshotRegion.x);
+                                configRoot["screenshotRegion"].append(screenshotRegion.y);
+                                configRoot["screenshotRegion"].append(screenshotRegion.width);
+                                configRoot["screenshotRegion"].append(screenshotRegion.height);
+                                //kept right away, the region is meant to be there on the next launch even if no card is saved
+                                writeConfig(configRoot, ++configVersionsSaved);
+                            }
+                            canvas.crop(cropRect);
+                            canvasTexture->markAllDirty();
                             addMode = 1;
                         }
                     }
@@ -616,7 +524,7 @@ int main( int argc, char* argv[] ) {
                     else if (addMode == 3) {
                         str = " Click and drag to crop \n the flashcard";
                     }
-                    multiLinePutText(canvasMat, str, cv::Point(mousePos.x - pos.x, mousePos.y - pos.y), font, 0.5, cv::Scalar(0, 0, 255, 255));
+                    addTextOverlay(str, mouseOnCanvas);
                 }                
             }
             else if (!ImGui::IsMouseDown(0)) {
@@ -624,23 +532,35 @@ int main( int argc, char* argv[] ) {
             }
         }
 
-        //update box positions and draw
-        for (std::pair<cv::Point, cv::Point> &boxBounds : answerBoxPositions) {
-            boxBounds.first += cv::Point(imageShiftAmountX, imageShiftAmountY);
-            boxBounds.second += cv::Point(imageShiftAmountX, imageShiftAmountY);
-            cv::rectangle(canvasMat, boxBounds.first, boxBounds.second, cv::Scalar(100, 0, 0, 255), 2);
+        //draw the boxes over the canvas
+        for (const std::pair<cv::Point, cv::Point>& boxBounds : answerBoxPositions) {
+            addBoxOverlay(boxBounds.first + canvas.origin(), boxBounds.second + canvas.origin(), IM_COL32(100, 0, 0, 255));
         }
-        for (std::pair<cv::Point, cv::Point> &boxBounds : questionBoxPositions) {
-            boxBounds.first += cv::Point(imageShiftAmountX, imageShiftAmountY);
-            boxBounds.second += cv::Point(imageShiftAmountX, imageShiftAmountY);
-            cv::rectangle(canvasMat, boxBounds.first, boxBounds.second, cv::Scalar(200, 0, 0, 255), 2);
+        for (const std::pair<cv::Point, cv::Point>& boxBounds : questionBoxPositions) {
+            addBoxOverlay(boxBounds.first + canvas.origin(), boxBounds.second + canvas.origin(), IM_COL32(200, 0, 0, 255));
         }
 
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
-        glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
-        glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
-        glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, canvasMat.cols, canvasMat.rows, 0, GL_RGBA, GL_UNSIGNED_BYTE, canvasMat.data );
-        ImGui::Image( reinterpret_cast<void*>( static_cast<intptr_t>( texture ) ), ImVec2(canvasMat.cols, canvasMat.rows ) );
+        //the card's tiles only change when the card does and only the ones in view are uploaded and drawn,
+        //the overlays are clipped to the view
+        canvasView.layout(canvas.size(), maxCanvasViewSize);
+        ImDrawList* canvasDrawList = ImGui::GetWindowDrawList();
+        cv::Rect visibleCanvasRegion = canvasView.visibleRegion();
+        FrameProfiler::Scope canvasUploadScope(profiler, "canvas upload");
+        frameUploadedBytes += canvasTexture->upload(canvas.image(), visibleCanvasRegion);
+        canvasUploadScope.stop();
+        canvasDrawList->PushClipRect(canvasView.viewMin(), canvasView.viewMax(), true);
+        canvasTexture->draw(canvasDrawList, canvasView.toScreen(cv::Point2f(0, 0)), canvasView.zoom(), visibleCanvasRegion);
+        for (const auto& drawOverlay : canvasOverlays) {
+            drawOverlay(canvasDrawList, canvasView);
+        }
+        canvasDrawList->PopClipRect();
+        frameUploadedBytes += overlayTextures->takeUploadedBytes();
+        ImGui::Text("Frame: %.1f ms, uploaded: %.1f KB", frameMilliseconds, lastFrameUploadedBytes / 1024.0); ImGui::SameLine();
+        ImGui::Checkbox("Profiler (F3)", &showProfiler);
+        ImGui::Text("Zoom: %.0f%% (ctrl+wheel to zoom, middle mouse to pan)", canvasView.zoom() * 100.0f); ImGui::SameLine();
+        if (ImGui::Button("Fit")) canvasView.fit(canvas.size(), maxCanvasViewSize);
+        ImGui::SameLine();
+        if (ImGui::Button("1:1")) canvasView.setZoom(1.0f, canvasView.viewMin());
 
         ImGui::RadioButton("Add Text/Image", &addMode, 0); ImGui::SameLine();
         ImGui::RadioButton("Add Answer Box", &addMode ,1); ImGui::SameLine();
@@ -660,89 +580,69 @@ int main( int argc, char* argv[] ) {
             toLowercase(topicStr);
             trim(topicStr);//do more checks to see if topicStr is an appropriate folder name
 
-            //create folder with topic's name
-            if (CreateDirectory(std::string(filePath + "/" + topicStr).c_str(), NULL) || ERROR_ALREADY_EXISTS == GetLastError()) {
-                std::ofstream saveFile(filePath + "/" + topicStr + "/" + std::string(fileName) + ".json");
-                std::ofstream configFile(envConfigPath);
-
-                Json::Value saveJsonRoot;
-                Json::StreamWriterBuilder builder;
-                const std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
-
-                if (!configRoot["lastUsedKeywords"].isArray()) {
-                    configRoot["lastUsedKeywords"] = Json::arrayValue;
-                }
-                else {
-                    configRoot["lastUsedKeywords"].clear();
-                }
+            if (!configRoot["lastUsedKeywords"].isArray()) {
+                configRoot["lastUsedKeywords"] = Json::arrayValue;
+            }
+            else {
+                configRoot["lastUsedKeywords"].clear();
+            }
 
-                //save meta-data
-                saveJsonRoot["topic"] = topicBuffer;
-                saveJsonRoot["keywords"] = Json::arrayValue;
-                std::string keywordsBufferStr(keywordsBuffer);
-                std::stringstream ss(keywordsBufferStr);
-                while (ss.good()) {
-                    std::string substr;
-                    std::getline(ss, substr, ',');
-                    trim(substr);
-                    toLowercase(substr);
-                    if (!substr.empty()) {
-                        saveJsonRoot["keywords"].append(substr.c_str());
-                        //save the last used keywords to the config file
-                        configRoot["lastUsedKeywords"].append(substr.c_str());
-                    }
+            std::vector<std::string> savedKeywords;
+            std::string keywordsBufferStr(keywordsBuffer);
+            std::stringstream ss(keywordsBufferStr);
+            while (ss.good()) {
+                std::string substr;
+                std::getline(ss, substr, ',');
+                trim(substr);
+                toLowercase(substr);
+                if (!substr.empty()) {
+                    savedKeywords.push_back(substr);
+                    //save the last used keywords to the config file
+                    configRoot["lastUsedKeywords"].append(substr.c_str());
                 }
-                //save the last used topic to the config file
-                configRoot["lastUsedTopic"] = topicBuffer;
-
-                //save boxes
-                int i = 0;
-                saveJsonRoot["answerBoxPositionsList"] = Json::arrayValue;
-                saveJsonRoot["questionBoxPositionsList"] = Json::arrayValue;
-                for (auto boxBoundsList : { answerBoxPositions, questionBoxPositions }) {
-                    for (std::pair<cv::Point, cv::Point>& boxBounds : boxBoundsList) {
-                        Json::Value boxPositions = Json::arrayValue;
-                        Json::Value boxTopLeftPosition = Json::arrayValue;
-                        boxTopLeftPosition.append(boxBounds.first.x);
-                        boxTopLeftPosition.append(boxBounds.first.y);
-                        boxPositions.append(boxTopLeftPosition);
-                        Json::Value boxBottomRightPosition = Json::arrayValue;
-                        boxBottomRightPosition.append(boxBounds.second.x);
-                        boxBottomRightPosition.append(boxBounds.second.y);
-                        boxPositions.append(boxBottomRightPosition);
-                        if (i == 0) {
-                            saveJsonRoot["answerBoxPositionsList"].append(boxPositions);
-                        }
-                        else {
-                            saveJsonRoot["questionBoxPositionsList"].append(boxPositions);
-                        }
-                    }
-                    i++;
-                }
-
-                
+            }
+            //save the last used topic to the config file
+            configRoot["lastUsedTopic"] = topicBuffer;
+
+            //encode and write on the worker pool; the snapshot shares the canvas' pixels until the editor draws into it again
+            cv::Mat imageSnapshot = canvas.image();
+            std::string fileNameStr(fileName);
+            std::vector<std::pair<cv::Point, cv::Point>> answerBoxSnapshot = answerBoxPositions;
+            std::vector<std::pair<cv::Point, cv::Point>> questionBoxSnapshot = questionBoxPositions;
+            for (std::pair<cv::Point, cv::Point>& boxBounds : answerBoxSnapshot) {
+                boxBounds = { boxBounds.first + canvas.origin(), boxBounds.second + canvas.origin() };
+            }
+            for (std::pair<cv::Point, cv::Point>& boxBounds : questionBoxSnapshot) {
+                boxBounds = { boxBounds.first + canvas.origin(), boxBounds.second + canvas.origin() };
+            }
+            Json::Value configSnapshot = configRoot;
+            unsigned configVersion = ++configVersionsSaved;
+            saveQueue.enqueue(fileNameStr, [=]() {
+                bool flashcardSaved = saveFlashcard(filePath, topicStr, fileNameStr, savedKeywords, answerBoxSnapshot, questionBoxSnapshot,
+                    imageSnapshot, flashcardImageFormat);
 
-                //save flashcard configuration
-                writer->write(saveJsonRoot, &saveFile);                
-                saveFile.close();
-                
                 //save app configuration
-                writer->write(configRoot, &configFile);
-                configFile.close();
-
-                //save image
-                cv::cvtColor(image, image, cv::COLOR_BGR2RGBA);
-                if (!cv::imwrite(filePath + "/" + topicStr + "/" + std::string(fileName) + ".png", image)) {
-                    std::cerr << "Error saving flashcard image." << std::endl;
-                }
-                cv::cvtColor(image, image, cv::COLOR_BGR2RGBA);
-            }
+                writeConfig(configSnapshot, configVersion);
+                return flashcardSaved;
+            });
+        }
+        for (const SaveQueue::Result& saveResult : saveQueue.takeFinished()) {
+            saveStatus = (saveResult.succeeded ? "Saved " : "Error saving ") + saveResult.fileName;
+        }
+        if (saveQueue.pendingCount() > 0) {
+            ImGui::Text("Saving %d flashcard(s)...", static_cast<int>(saveQueue.pendingCount())); ImGui::SameLine();
+        }
+        else if (!saveStatus.empty()) {
+            ImGui::Text("%s", saveStatus.c_str()); ImGui::SameLine();
         }
 
         bool openButton = ImGui::Button("Open Image"); ImGui::SameLine();
         if (ImGui::Button("New Flashcard")) {
             makeFileName(fileName);
-            image = cv::Mat(400, 800, CV_8UC4, cv::Scalar(255, 255, 255, 255));
+            canvas.reset(cv::Mat(400, 800, CV_8UC4, cv::Scalar(255, 255, 255, 255)));
+            canvasFromScreen = false;
+            canvasTexture->markAllDirty();
+            canvasView.fit(canvas.size(), maxCanvasViewSize);
             answerBoxPositions.clear();
             questionBoxPositions.clear();
         }
@@ -750,61 +650,158 @@ int main( int argc, char* argv[] ) {
         if (ImGui::Button("Take Screenshot")) {
             takeScreenshot = true;
         }
-        if (takeScreenshot) {
-            takeScreenshot = false;
-            glfwHideWindow(window);
-            std::this_thread::sleep_for(std::chrono::milliseconds(200));
-            GetScreenShot();
-            copyFromClipboard(imageFromClipboard);
-            cv::cvtColor(imageFromClipboard, imageFromClipboard, cv::COLOR_BGR2RGBA);
-            if (!imageFromClipboard.empty()) {
-                image = imageFromClipboard;
-                addMode = 3;
+        //cropping a screenshot remembers the region, after that only the region is grabbed and converted
+        bool captureRegion = false;
+        if (!screenshotRegion.empty()) {
+            ImGui::SameLine();
+            captureRegion = ImGui::Button("Capture Region (F5)") || ImGui::IsKeyPressed(GLFW_KEY_F5, false);
+        }
+        if ((takeScreenshot || captureRegion) && screenCapture) {
+            cv::Rect region = (captureRegion ? screenshotRegion : screenCapture->screenBounds()) & screenCapture->screenBounds();
+
+            //the window only has to leave the screen when it is in the shot, and the window manager needs time to take it off
+            int windowX, windowY, windowWidth, windowHeight, frameLeft, frameTop, frameRight, frameBottom;
+            glfwGetWindowPos(window, &windowX, &windowY);
+            glfwGetWindowSize(window, &windowWidth, &windowHeight);
+            glfwGetWindowFrameSize(window, &frameLeft, &frameTop, &frameRight, &frameBottom);
+            cv::Rect windowRect(windowX - frameLeft, windowY - frameTop, windowWidth + frameLeft + frameRight, windowHeight + frameTop + frameBottom);
+            bool hideWindow = !(windowRect & region).empty();
+            if (hideWindow) {
+                glfwHideWindow(window);
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
             }
-            glfwShowWindow(window);
+            cv::Mat screenFrame;
+            if (screenCapture->grab(region, screenFrame)) {
+                //the frame's fourth byte is padding, the converted card is opaque
+                cv::Mat screenshot;
+                PixelSwizzle::bgrxToRgba(screenFrame, screenshot);
+                canvas.reset(screenshot);
+                canvasFromScreen = true;
+                screenshotScreenPos = region.tl();
+                canvasTexture->markAllDirty();
+                canvasView.fit(canvas.size(), maxCanvasViewSize);
+                addMode = captureRegion ? 1 : 3;
+            }
+            if (hideWindow) glfwShowWindow(window);
         }
+        takeScreenshot = false;
         static bool showPresentFlashcardsWindow = false;
         if (ImGui::Button("Present flashcards")) {
             showPresentFlashcardsWindow = true;
         }
         ImGui::End();
+        editorScope.stop();
 
         if (showPresentFlashcardsWindow) {
+            FrameProfiler::Scope presenterScope(profiler, "presenter");
             ImGui::Begin("Present flashcards");
 
             static char topicsBuffer[1000];
             static char keywordsBuffer[1000];
             static std::vector<std::string> searchTopics;
             static std::vector<std::string> searchKeywords;
-            static std::vector<std::string> foundFlashcardFileNames;
+            static std::shared_ptr<const std::vector<FlashcardRef>> foundFlashcards = std::make_shared<const std::vector<FlashcardRef>>();
+            static std::vector<std::string> foundTopics;
+            static std::vector<std::string> foundKeywords;
+            static std::future<std::vector<FlashcardRef>> pendingSearch;
+            static std::vector<std::string> pendingTopics;
+            static std::vector<std::string> pendingKeywords;
+            static std::shared_ptr<std::atomic<bool>> searchCancelled;
+            static bool searchStarted = false;
+            static bool searchFinished = false;
+            static bool refreshingSearch = false;
+            static bool queryEdited = false;
+            static std::chrono::steady_clock::time_point queryEditedAt;
+            static const std::chrono::milliseconds searchDebounce(configRoot.get("searchDebounceMilliseconds", 150).asInt());
+            static FlashcardPrefetcher prefetcher(configRoot.get("presenterPrefetchDepth", 3).asUInt());
             static std::vector<std::pair<cv::Point, cv::Point>> currentFlashcardAnswerBoxBounds;
             static std::vector<std::pair<cv::Point, cv::Point>> currentFlashcardQuestionBoxBounds;
             static bool showNewFlashcard = true;
+            static PresentedFlashcard incomingFlashcard;
+            static bool hasIncomingFlashcard = false;
             static bool hidingAnswer = true;
             static bool hidingQuestion = false;
             static std::string flashcardKeywordsStr;
             ImGui::InputTextWithHint("Topics", "Filter by topics (seperate with commas)", topicsBuffer, IM_ARRAYSIZE(topicsBuffer),
                 ImGuiInputTextFlags_CallbackResize, topicsFilterCallback);
-            if (topicsFilterCallbackCalled) {
-                std::cout << topicsBuffer << std::endl;
-                topicsFilterCallbackCalled = false;
-            }
             ImGui::InputTextWithHint("Keywords", "Filter by keywords (seperate with commas)", keywordsBuffer, IM_ARRAYSIZE(keywordsBuffer),
                 ImGuiInputTextFlags_CallbackResize, keywordsFilterCallback);
-            if (keywordsFilterCallbackCalled) {
+            if (topicsFilterCallbackCalled || keywordsFilterCallbackCalled) {
+                searchTopics = parseTopics(topicsBuffer);
+                searchKeywords = parseKeywords(keywordsBuffer);
+                queryEdited = true;
+                queryEditedAt = std::chrono::steady_clock::now();
+                topicsFilterCallbackCalled = false;
+                keywordsFilterCallbackCalled = false;
+            }
+
+            //cards changed on disk refresh the results without moving off the current card
+            bool startSearch = catalogChanged.exchange(false) && searchStarted;
+            bool refineResults = false;
+            if (queryEdited && !startSearch) {
+                if (searchStarted && searchTopics == pendingTopics && searchKeywords == pendingKeywords) {
+                    //the edit did not change the query, e.g. a trailing comma was typed
+                    queryEdited = false;
+                }
+                else if (searchFinished && searchTopics == foundTopics
+                    && std::includes(searchKeywords.begin(), searchKeywords.end(), foundKeywords.begin(), foundKeywords.end())) {
+                    //adding keywords can only shrink the results, so narrow the ones already found straight away
+                    startSearch = true;
+                    refineResults = true;
+                }
+                else if (std::chrono::steady_clock::now() - queryEditedAt >= searchDebounce) {
+                    //searching from scratch waits for typing to pause
+                    startSearch = true;
+                }
+                else {
+                    wakeWithin(std::chrono::duration<double>(queryEditedAt + searchDebounce - std::chrono::steady_clock::now()).count());
+                }
+            }
+            if (startSearch) {
                 std::string fileSavePath = configRoot["flashcardSavePath"].asString();
-                searchKeywords = splitString(keywordsBuffer, ",");
-                for (std::string &keyword : searchKeywords) {
-                    trim(keyword);
-                    toLowercase(keyword);
+                refreshingSearch = !queryEdited;
+                //search off the ui thread, dropping whatever search is still running for the old query
+                if (searchCancelled) *searchCancelled = true;
+                searchCancelled = std::make_shared<std::atomic<bool>>(false);
+                std::vector<std::string> topics = searchTopics;
+                std::vector<std::string> keywords = searchKeywords;
+                std::shared_ptr<std::atomic<bool>> cancelled = searchCancelled;
+                if (refineResults) {
+                    std::shared_ptr<const std::vector<FlashcardRef>> flashcards = foundFlashcards;
+                    pendingSearch = WorkerPool::shared().submit([fileSavePath, flashcards, keywords, cancelled]() {
+                        return refineSearch(fileSavePath, *flashcards, keywords, cancelled.get());
+                    });
+                }
+                else {
+                    pendingSearch = WorkerPool::shared().submit([fileSavePath, topics, keywords, cancelled]() {
+                        return searchForFlashcards(fileSavePath, topics, keywords, cancelled.get());
+                    });
+                }
+                pendingTopics = topics;
+                pendingKeywords = keywords;
+                searchStarted = true;
+                queryEdited = false;
+            }
+            if (pendingSearch.valid() && pendingSearch.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                foundFlashcards = std::make_shared<const std::vector<FlashcardRef>>(pendingSearch.get());
+                foundTopics = pendingTopics;
+                foundKeywords = pendingKeywords;
+                searchFinished = true;
+                prefetcher.reset(configRoot["flashcardSavePath"].asString(), foundFlashcards);
+                if (!refreshingSearch) {
+                    showNewFlashcard = true;
+                    hasIncomingFlashcard = false;
                 }
-                foundFlashcardFileNames = searchForFlashcards(fileSavePath, topicsBuffer, searchKeywords);
-                keywordsFilterCallbackCalled = false;
-                showNewFlashcard = true;
             }
             std::string numFlashcardString = "Flashcards found: ";
-            numFlashcardString += std::to_string(foundFlashcardFileNames.size());
+            numFlashcardString += std::to_string(foundFlashcards->size());
             ImGui::Text(numFlashcardString.c_str());
+            if (prefetcher.noLoadableCards()) {
+                ImGui::Text("None of the flashcards found could be loaded");
+            }
+            FlashcardImageCache::Stats imageCacheStats = FlashcardImageCache::shared().stats();
+            ImGui::Text("Image cache: %llu hits, %llu misses, %.1f MB", static_cast<unsigned long long>(imageCacheStats.hits),
+                static_cast<unsigned long long>(imageCacheStats.misses), imageCacheStats.bytes / (1024.0 * 1024.0));
 
             if (hidingAnswer) {
                 if (ImGui::Button("Show answer")) {
@@ -819,56 +816,100 @@ int main( int argc, char* argv[] ) {
             else {
                 if (ImGui::Button("Next flashcard")) {
                     showNewFlashcard = true;
-                    hidingAnswer = true;
                 }
             }
 
-            //load a random flashcard
-            if (showNewFlashcard && !foundFlashcardFileNames.empty()) {
+            //take the next random flashcard once the prefetcher has it decoded, and show it once its pixels have
+            //been streamed to its texture, the current card stays up until then
+            static PresentedFlashcard presentedFlashcard;
+            static CanvasView cardView;
+            ImVec2 maxCardViewSize(ImGui::GetIO().DisplaySize.x * 0.8f, ImGui::GetIO().DisplaySize.y * 0.7f);
+            if (showNewFlashcard && !hasIncomingFlashcard && !foundFlashcards->empty() && prefetcher.takeNext(incomingFlashcard)) {
                 showNewFlashcard = false;
-                std::string fileSavePath = configRoot["flashcardSavePath"].asString();
-                int ri = rand() % foundFlashcardFileNames.size();
-                currentFlashcardImage = loadFlashcardImage(fileSavePath, topicsBuffer, foundFlashcardFileNames[ri]);
-                currentFlashcardAnswerBoxBounds.clear();
-                currentFlashcardQuestionBoxBounds.clear();
-                loadFlashcardBoxBounds(fileSavePath, topicsBuffer, foundFlashcardFileNames[ri],
-                    currentFlashcardAnswerBoxBounds, currentFlashcardQuestionBoxBounds);
+                hasIncomingFlashcard = true;
+            }
+            FrameProfiler::Scope cardTextureScope(profiler, "card texture");
+            if (hasIncomingFlashcard && cardTextures->streamTexture(incomingFlashcard.topic + "/" + incomingFlashcard.fileName,
+                incomingFlashcard.image, incomingFlashcard.imageVersion) != 0) {
+                hasIncomingFlashcard = false;
+                presentedFlashcard = std::move(incomingFlashcard);
+                currentFlashcardImage = presentedFlashcard.image;
+                cardView.fit(currentFlashcardImage.size(), maxCardViewSize);
+                currentFlashcardAnswerBoxBounds.swap(presentedFlashcard.answerBoxBounds);
+                currentFlashcardQuestionBoxBounds.swap(presentedFlashcard.questionBoxBounds);
+                hidingAnswer = true;
+                hidingQuestion = false;
                 //choose wether to hide the answer or the question
                 if (!currentFlashcardQuestionBoxBounds.empty()) {
                     hidingAnswer = (rand() % 2) == 0;
                     hidingQuestion = !hidingAnswer;
                 }                
             }
-            currentFlashcardImage.copyTo(currentFlashcardCanvas);            
-
-            //draw boxes
-            if (hidingAnswer) {
-                for (std::pair<cv::Point, cv::Point>& boxBounds : currentFlashcardAnswerBoxBounds) {
-                    cv::rectangle(currentFlashcardCanvas, boxBounds.first, boxBounds.second, cv::Scalar(100, 0, 0, 255), cv::FILLED);
-                }
-            }
-            if (hidingQuestion) {
-                for (std::pair<cv::Point, cv::Point>& boxBounds : currentFlashcardQuestionBoxBounds) {
-                    cv::rectangle(currentFlashcardCanvas, boxBounds.first, boxBounds.second, cv::Scalar(100, 0, 0, 255), cv::FILLED);
+            //each card keeps its own texture, which is only uploaded the first time the card's decoded image is shown
+            frameUploadedBytes += cardTextures->takeUploadedBytes();
+            if (!currentFlashcardImage.empty()) {
+                std::string cardTextureKey = presentedFlashcard.topic + "/" + presentedFlashcard.fileName;
+                GLuint cardTexture = cardTextures->texture(cardTextureKey, currentFlashcardImage, presentedFlashcard.imageVersion);
+                frameUploadedBytes += cardTextures->takeUploadedBytes();
+                cardTextureScope.stop();
+                cardView.layout(currentFlashcardImage.size(), maxCardViewSize);
+                ImDrawList* drawList = ImGui::GetWindowDrawList();
+                drawList->PushClipRect(cardView.viewMin(), cardView.viewMax(), true);
+                drawList->AddImage(reinterpret_cast<void*>(static_cast<intptr_t>(cardTexture)), cardView.toScreen(cv::Point2f(0, 0)),
+                    cardView.toScreen(cv::Point2f(currentFlashcardImage.cols, currentFlashcardImage.rows)));
+
+                //hide the answer or the question by drawing over the card instead of into it
+                for (int i = 0; i < 2; i++) {
+                    if ((i == 0 && !hidingAnswer) || (i == 1 && !hidingQuestion)) continue;
+                    for (const std::pair<cv::Point, cv::Point>& boxBounds : i == 0 ? currentFlashcardAnswerBoxBounds : currentFlashcardQuestionBoxBounds) {
+                        ImVec2 boxMin = cardView.toScreen(cv::Point2f(std::min(boxBounds.first.x, boxBounds.second.x), std::min(boxBounds.first.y, boxBounds.second.y)));
+                        ImVec2 boxMax = cardView.toScreen(cv::Point2f(std::max(boxBounds.first.x, boxBounds.second.x) + 1, std::max(boxBounds.first.y, boxBounds.second.y) + 1));
+                        drawList->AddRectFilled(boxMin, boxMax, IM_COL32(100, 0, 0, 255));
+                    }
                 }
-            }
+                drawList->PopClipRect();
 
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, currentFlashcardCanvas.cols, currentFlashcardCanvas.rows,
-                0, GL_RGBA, GL_UNSIGNED_BYTE, currentFlashcardCanvas.data);
-            ImGui::Image(reinterpret_cast<void*>(static_cast<intptr_t>(texture)), ImVec2(currentFlashcardCanvas.cols, currentFlashcardCanvas.rows));
+                ImGui::Text("Zoom: %.0f%%", cardView.zoom() * 100.0f); ImGui::SameLine();
+                if (ImGui::Button("Fit")) cardView.fit(currentFlashcardImage.size(), maxCardViewSize);
+                ImGui::SameLine();
+                if (ImGui::Button("1:1")) cardView.setZoom(1.0f, cardView.viewMin());
+            }
             
+            ImGui::Text("Current flashcard topic: %s", presentedFlashcard.topic.c_str());
             ImGui::Text("Current flashcard keywords:");
             ImGui::Button("Back to creating flashcards");
 
             ImGui::End();
         }
 
+        if (showProfiler) {
+            profiler.drawOverlay(&showProfiler);
+        }
+
+        //the text cursor blinks while a text field is active
+        if (ImGui::GetIO().WantTextInput) wakeWithin(0.5);
+
+        FrameProfiler::Scope renderScope(profiler, "render");
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData( ImGui::GetDrawData() );
+        renderScope.stop();
 
+        FrameProfiler::Scope swapScope(profiler, "swap");
         glfwSwapBuffers( window );
+        swapScope.stop();
+        frameMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        profiler.endFrame();
     }
 
+    //let saves that are still running finish before exiting
+    saveQueue.waitForAll();
+    WorkerPool::shared().setTaskFinishedCallback(nullptr);
+    catalog.stop();
+
+    canvasTexture.reset();
+    cardTextures.reset();
+    overlayTextures.reset();
+
     ImGui_ImplGlfw_Shutdown();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui::DestroyContext();
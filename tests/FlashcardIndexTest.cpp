@@ -0,0 +1,141 @@
+// Checks FlashcardIndex queries and refines against a brute force scan of the cards' keywords, and that
+// indexes survive being saved, loaded and updated.
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <FlashcardIndex.hpp>
+#include "TestCheck.hpp"
+
+namespace {
+    const std::string topic = "topic";
+
+    std::string keywordName(int keyword) {
+        return "keyword-" + std::to_string(keyword);
+    }
+
+    std::string flashcardName(int card) {
+        char name[32];
+        snprintf(name, sizeof(name), "Flashcard-%05d", card);
+        return name;
+    }
+
+    void writeCard(const std::string& directory, const std::string& flashcardId, const std::set<std::string>& keywords) {
+        std::ofstream card(directory + "/" + topic + "/" + flashcardId + ".json");
+        card << "{ \"topic\" : \"" << topic << "\", \"keywords\" : [";
+        bool first = true;
+        for (const std::string& keyword : keywords) {
+            card << (first ? "" : ", ") << "\"" << keyword << "\"";
+            first = false;
+        }
+        card << "] }";
+    }
+
+    std::vector<std::string> bruteForceQuery(const std::map<std::string, std::set<std::string>>& cards, const std::vector<std::string>& keywords) {
+        std::vector<std::string> flashcardIds;
+        for (const auto& card : cards) {
+            bool hasAll = true;
+            for (const std::string& keyword : keywords) {
+                if (!keyword.empty() && card.second.count(keyword) == 0) hasAll = false;
+            }
+            if (hasAll) flashcardIds.push_back(card.first);
+        }
+        return flashcardIds;
+    }
+
+    std::vector<std::string> randomKeywords(std::mt19937& rng) {
+        std::vector<std::string> keywords;
+        int keywordCount = std::uniform_int_distribution<int>(0, 3)(rng);
+        for (int i = 0; i < keywordCount; i++) {
+            //a few keywords no card has, and the empty keyword which is ignored
+            int keyword = std::uniform_int_distribution<int>(-1, 13)(rng);
+            keywords.push_back(keyword == -1 ? std::string() : keywordName(keyword));
+        }
+        return keywords;
+    }
+}
+
+int main() {
+    std::string directory = (std::filesystem::temp_directory_path() / "FlashcardIndexTest").string();
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory + "/" + topic);
+
+    //cards with zipf-like keywords, so some posting lists are long and others short
+    std::mt19937 rng(7);
+    std::map<std::string, std::set<std::string>> cards;
+    for (int i = 0; i < 400; i++) {
+        std::set<std::string> keywords;
+        int keywordCount = std::uniform_int_distribution<int>(0, 4)(rng);
+        for (int k = 0; k < keywordCount; k++) {
+            keywords.insert(keywordName(std::min(std::uniform_int_distribution<int>(0, 11)(rng), std::uniform_int_distribution<int>(0, 11)(rng))));
+        }
+        cards[flashcardName(i)] = keywords;
+        writeCard(directory, flashcardName(i), keywords);
+    }
+    //a card that can not be parsed is left out of the index
+    std::ofstream(directory + "/" + topic + "/Flashcard-broken.json") << "{ \"keywords\" : [";
+
+    FlashcardIndex::TopicIndex index = FlashcardIndex::buildTopicIndex(directory, topic);
+    std::vector<std::string> allIds;
+    for (const auto& card : cards) allIds.push_back(card.first);
+    CHECK(index.flashcardIds == allIds);
+
+    for (int i = 0; i < 300; i++) {
+        std::vector<std::string> keywords = randomKeywords(rng);
+        CHECK(FlashcardIndex::query(index, keywords) == bruteForceQuery(cards, keywords));
+
+        //refining keeps the given ids that the index has and that have all of the keywords, ids the index does
+        //not know about (packed cards) are dropped
+        std::vector<std::string> earlierResults;
+        for (const auto& card : cards) {
+            if (rng() % 3 == 0) earlierResults.push_back(card.first);
+        }
+        earlierResults.push_back("Packed-only");
+        std::sort(earlierResults.begin(), earlierResults.end());
+        std::vector<std::string> expected;
+        std::vector<std::string> matching = bruteForceQuery(cards, keywords);
+        std::set_intersection(earlierResults.begin(), earlierResults.end(), matching.begin(), matching.end(), std::back_inserter(expected));
+        CHECK(FlashcardIndex::refine(index, earlierResults, keywords) == expected);
+    }
+
+    //saved and loaded again the index is the same, and no temporary file is left behind
+    CHECK(FlashcardIndex::saveTopicIndex(index));
+    FlashcardIndex::TopicIndex loadedIndex;
+    CHECK(FlashcardIndex::loadTopicIndex(index.indexPath, loadedIndex));
+    CHECK(loadedIndex.directoryWriteTime == index.directoryWriteTime);
+    CHECK(loadedIndex.flashcardIds == index.flashcardIds);
+    CHECK(loadedIndex.postings == index.postings);
+    for (const auto& dirEntry : std::filesystem::directory_iterator(directory)) {
+        CHECK(dirEntry.path().extension() != ".tmp");
+    }
+
+    //updates replace a card's keywords and remove cards, in the cached index and the one on disk
+    std::shared_ptr<const FlashcardIndex::TopicIndex> cachedIndex = FlashcardIndex::getTopicIndex(directory, topic);
+    CHECK(cachedIndex && cachedIndex->flashcardIds == allIds);
+    cards[flashcardName(3)] = { "keyword-new", keywordName(0) };
+    writeCard(directory, flashcardName(3), cards[flashcardName(3)]);
+    FlashcardIndex::addFlashcard(directory, topic, flashcardName(3), { "keyword-new", keywordName(0) });
+    cards.erase(flashcardName(5));
+    std::filesystem::remove(directory + "/" + topic + "/" + flashcardName(5) + ".json");
+    FlashcardIndex::updateFlashcards(directory, topic, {}, { flashcardName(5) });
+
+    cachedIndex = FlashcardIndex::getTopicIndex(directory, topic);
+    CHECK(cachedIndex != nullptr);
+    FlashcardIndex::TopicIndex savedIndex;
+    CHECK(FlashcardIndex::loadTopicIndex(index.indexPath, savedIndex));
+    for (const std::vector<std::string>& keywords : std::vector<std::vector<std::string>>{
+        {}, { "keyword-new" }, { keywordName(0) }, { keywordName(0), keywordName(1) } }) {
+        if (cachedIndex) CHECK(FlashcardIndex::query(*cachedIndex, keywords) == bruteForceQuery(cards, keywords));
+        CHECK(FlashcardIndex::query(savedIndex, keywords) == bruteForceQuery(cards, keywords));
+    }
+
+    std::filesystem::remove_all(directory);
+    std::filesystem::remove(FlashcardIndex::indexPathForTopic(directory, topic));
+    return TEST_RESULT();
+}
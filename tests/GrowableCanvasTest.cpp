@@ -0,0 +1,105 @@
+// Checks GrowableCanvas against a plain image of the whole card in origin coordinates through random pastes (inside
+// and past every side), crops and draws, and that images handed out before a change keep their pixels.
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+
+#include <opencv2/core.hpp>
+
+#include <GrowableCanvas.hpp>
+#include "TestCheck.hpp"
+
+namespace {
+    const cv::Scalar white(255, 255, 255, 255);
+
+    cv::Mat randomImage(int rows, int cols, std::mt19937& rng) {
+        cv::Mat image(rows, cols, CV_8UC4);
+        for (int y = 0; y < rows; y++) {
+            uint8_t* row = image.ptr<uint8_t>(y);
+            for (int i = 0; i < cols * 4; i++) row[i] = static_cast<uint8_t>(rng());
+        }
+        return image;
+    }
+
+    int randomInt(std::mt19937& rng, int low, int high) {
+        return std::uniform_int_distribution<int>(low, high)(rng);
+    }
+}
+
+int main() {
+    std::mt19937 rng(5);
+
+    //the whole card drawn in one large image, with the canvas' origin at its center. the card's image is the
+    //part of it at imageRect, everything else is kept as background since the canvas forgets what it crops away
+    cv::Mat reference(1200, 1200, CV_8UC4, white);
+    const cv::Point referenceOrigin(600, 600);
+
+    cv::Mat start = randomImage(15, 20, rng);
+    GrowableCanvas canvas(start);
+    start.copyTo(reference(cv::Rect(referenceOrigin, start.size())));
+    cv::Rect imageRect(referenceOrigin, start.size());
+    CHECK(canvas.origin() == cv::Point(0, 0));
+    CHECK(TestCheck::sameImage(canvas.image(), start));
+
+    for (int step = 0; step < 400; step++) {
+        //an image kept by a pending save, it must not see any of this step's changes
+        cv::Mat snapshot = canvas.image();
+        cv::Mat snapshotPixels = snapshot.clone();
+
+        int action = randomInt(rng, 0, 5);
+        if (action <= 2) {
+            cv::Mat source = randomImage(randomInt(rng, 1, 30), randomInt(rng, 1, 30), rng);
+            cv::Point pos(randomInt(rng, -40, imageRect.width + 10), randomInt(rng, -40, imageRect.height + 10));
+            cv::Rect pasted(imageRect.tl() + pos, source.size());
+            cv::Rect region = canvas.paste(source, pos);
+            source.copyTo(reference(pasted));
+            imageRect |= pasted;
+            CHECK(region == pasted - imageRect.tl());
+        }
+        else if (action == 3) {
+            cv::Mat drawn = canvas.writableImage();
+            cv::Rect area(randomInt(rng, 0, imageRect.width - 1), randomInt(rng, 0, imageRect.height - 1), 0, 0);
+            area.width = randomInt(rng, 1, imageRect.width - area.x);
+            area.height = randomInt(rng, 1, imageRect.height - area.y);
+            cv::Scalar color(randomInt(rng, 0, 255), randomInt(rng, 0, 255), randomInt(rng, 0, 255), 255);
+            drawn(area).setTo(color);
+            reference(area + imageRect.tl()).setTo(color);
+        }
+        else {
+            //crops keep the origin's pixel on the card so it stays near the reference's center, and sometimes
+            //reach past the image, which only keeps the part inside it
+            cv::Point origin = canvas.origin();
+            cv::Rect region(origin.x - randomInt(rng, 0, 60), origin.y - randomInt(rng, 0, 60), 0, 0);
+            region.width = origin.x - region.x + randomInt(rng, 1, 60);
+            region.height = origin.y - region.y + randomInt(rng, 1, 60);
+            cv::Rect kept = (region + imageRect.tl()) & imageRect;
+            canvas.crop(region);
+            cv::Mat croppedReference(reference.size(), reference.type(), white);
+            reference(kept).copyTo(croppedReference(kept));
+            reference = croppedReference;
+            imageRect = kept;
+        }
+
+        CHECK(canvas.size() == imageRect.size());
+        CHECK(canvas.origin() == referenceOrigin - imageRect.tl());
+        CHECK(TestCheck::sameImage(canvas.image(), reference(imageRect)));
+        CHECK(TestCheck::sameImage(snapshot, snapshotPixels));
+    }
+
+    //crops that miss the image leave it alone
+    cv::Rect before(canvas.origin(), canvas.size());
+    canvas.crop(cv::Rect(canvas.size().width + 5, 0, 10, 10));
+    CHECK(canvas.size() == before.size() && canvas.origin() == before.tl());
+
+    //reset starts over from the new image with the origin at its top left
+    cv::Mat other = randomImage(4, 9, rng);
+    canvas.reset(other);
+    CHECK(canvas.origin() == cv::Point(0, 0));
+    CHECK(TestCheck::sameImage(canvas.image(), other));
+    cv::Rect region = canvas.paste(randomImage(3, 3, rng), cv::Point(-2, -1));
+    CHECK(region == cv::Rect(0, 0, 3, 3));
+    CHECK(canvas.origin() == cv::Point(2, 1) && canvas.size() == cv::Size(11, 5));
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,116 @@
+// Checks the PixelSwizzle kernels picked for this cpu against a plain per pixel conversion, for every short row length
+// and unaligned start so the vector bodies and their scalar tails are both covered.
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include <PixelSwizzle.hpp>
+#include "TestCheck.hpp"
+
+namespace {
+    void swapRedBlueReference(const uint8_t* src, uint8_t* dst, size_t pixelCount) {
+        for (size_t i = 0; i < pixelCount; i++) {
+            dst[i * 4 + 0] = src[i * 4 + 2];
+            dst[i * 4 + 1] = src[i * 4 + 1];
+            dst[i * 4 + 2] = src[i * 4 + 0];
+            dst[i * 4 + 3] = src[i * 4 + 3];
+        }
+    }
+
+    void bgrxToRgbaReference(const uint8_t* src, uint8_t* dst, size_t pixelCount) {
+        for (size_t i = 0; i < pixelCount; i++) {
+            dst[i * 4 + 0] = src[i * 4 + 2];
+            dst[i * 4 + 1] = src[i * 4 + 1];
+            dst[i * 4 + 2] = src[i * 4 + 0];
+            dst[i * 4 + 3] = 255;
+        }
+    }
+
+    void bgrToRgbaReference(const uint8_t* src, uint8_t* dst, size_t pixelCount) {
+        for (size_t i = 0; i < pixelCount; i++) {
+            dst[i * 4 + 0] = src[i * 3 + 2];
+            dst[i * 4 + 1] = src[i * 3 + 1];
+            dst[i * 4 + 2] = src[i * 3 + 0];
+            dst[i * 4 + 3] = 255;
+        }
+    }
+
+    typedef void (*RowKernel)(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+
+    // the source ends right after its pixels so reading past them shows up under a sanitizer, and the bytes after
+    // the destination row are checked so writing past them shows up here
+    void checkRowKernel(RowKernel kernel, RowKernel reference, int srcBytesPerPixel, std::mt19937& rng) {
+        const size_t guard = 64;
+        for (size_t pixelCount = 0; pixelCount <= 70; pixelCount++) {
+            for (size_t offset = 0; offset < 4; offset++) {
+                std::vector<uint8_t> src(offset + pixelCount * srcBytesPerPixel);
+                for (uint8_t& byte : src) byte = static_cast<uint8_t>(rng());
+                std::vector<uint8_t> dst(offset + pixelCount * 4 + guard, 0xcd);
+                std::vector<uint8_t> expected = dst;
+                kernel(src.data() + offset, dst.data() + offset, pixelCount);
+                reference(src.data() + offset, expected.data() + offset, pixelCount);
+                CHECK(dst == expected);
+            }
+        }
+    }
+
+    cv::Mat randomImage(int rows, int cols, int type, std::mt19937& rng) {
+        cv::Mat image(rows, cols, type);
+        for (int y = 0; y < rows; y++) {
+            uint8_t* row = image.ptr<uint8_t>(y);
+            for (size_t i = 0; i < cols * image.elemSize(); i++) row[i] = static_cast<uint8_t>(rng());
+        }
+        return image;
+    }
+
+    cv::Mat convertReference(const cv::Mat& src, RowKernel reference) {
+        cv::Mat dst(src.rows, src.cols, CV_8UC4);
+        for (int y = 0; y < src.rows; y++) {
+            reference(src.ptr<uint8_t>(y), dst.ptr<uint8_t>(y), src.cols);
+        }
+        return dst;
+    }
+}
+
+int main() {
+    std::cout << "PixelSwizzle implementation: " << PixelSwizzle::implementationName() << std::endl;
+    std::mt19937 rng(11);
+
+    checkRowKernel(PixelSwizzle::swapRedBlueRow, swapRedBlueReference, 4, rng);
+    checkRowKernel(PixelSwizzle::bgrxToRgbaRow, bgrxToRgbaReference, 4, rng);
+    checkRowKernel(PixelSwizzle::bgrToRgbaRow, bgrToRgbaReference, 3, rng);
+
+    //whole images with odd widths, as views into larger images so their rows are not continuous
+    for (int cols : { 1, 7, 33, 101 }) {
+        cv::Mat rgbaParent = randomImage(9, cols + 6, CV_8UC4, rng);
+        cv::Mat rgba = rgbaParent(cv::Rect(3, 2, cols, 5));
+        cv::Mat bgrParent = randomImage(9, cols + 6, CV_8UC3, rng);
+        cv::Mat bgr = bgrParent(cv::Rect(1, 3, cols, 5));
+
+        cv::Mat dst;
+        PixelSwizzle::swapRedBlue(rgba, dst);
+        CHECK(TestCheck::sameImage(dst, convertReference(rgba, swapRedBlueReference)));
+        PixelSwizzle::bgrxToRgba(rgba, dst);
+        CHECK(TestCheck::sameImage(dst, convertReference(rgba, bgrxToRgbaReference)));
+        PixelSwizzle::bgrToRgba(bgr, dst);
+        CHECK(TestCheck::sameImage(dst, convertReference(bgr, bgrToRgbaReference)));
+
+        //in place, leaving the rest of the parent image alone
+        cv::Mat parentBefore = rgbaParent.clone();
+        cv::Mat expected = convertReference(rgba, swapRedBlueReference);
+        PixelSwizzle::swapRedBlue(rgba, rgba);
+        CHECK(TestCheck::sameImage(rgba, expected));
+        expected = convertReference(rgba, bgrxToRgbaReference);
+        PixelSwizzle::bgrxToRgba(rgba, rgba);
+        CHECK(TestCheck::sameImage(rgba, expected));
+        parentBefore(cv::Rect(3, 2, cols, 5)).setTo(cv::Scalar(0, 0, 0, 0));
+        rgba.setTo(cv::Scalar(0, 0, 0, 0));
+        CHECK(TestCheck::sameImage(rgbaParent, parentBefore));
+    }
+
+    return TEST_RESULT();
+}
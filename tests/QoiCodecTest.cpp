@@ -0,0 +1,136 @@
+// Checks that QoiCodec round-trips images exactly and rejects truncated or malformed data without reading past it.
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include <QoiCodec.hpp>
+#include "TestCheck.hpp"
+
+namespace {
+    // pixels that exercise every op: long runs (past the 62 pixel limit of one run), small and larger differences
+    // to the previous pixel, repeats of earlier colors, full RGB and alpha changes
+    cv::Mat makeImage(int rows, int cols, std::mt19937& rng) {
+        cv::Mat image(rows, cols, CV_8UC4);
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::uniform_int_distribution<int> kind(0, 5);
+        unsigned char previous[4] = { 0, 0, 0, 255 };
+        for (int y = 0; y < rows; y++) {
+            unsigned char* row = image.ptr<unsigned char>(y);
+            for (int x = 0; x < cols; x++) {
+                unsigned char* px = row + x * 4;
+                int pixelKind = y < 2 ? 0 : kind(rng);
+                for (int c = 0; c < 4; c++) px[c] = previous[c];
+                if (pixelKind == 1) {
+                    for (int c = 0; c < 3; c++) px[c] = static_cast<unsigned char>(previous[c] + byte(rng) % 3 - 1);
+                }
+                else if (pixelKind == 2) {
+                    int dg = byte(rng) % 40 - 20;
+                    px[0] = static_cast<unsigned char>(previous[0] + dg + byte(rng) % 9 - 4);
+                    px[1] = static_cast<unsigned char>(previous[1] + dg);
+                    px[2] = static_cast<unsigned char>(previous[2] + dg + byte(rng) % 9 - 4);
+                }
+                else if (pixelKind == 3) {
+                    for (int c = 0; c < 3; c++) px[c] = static_cast<unsigned char>(byte(rng));
+                }
+                else if (pixelKind == 4) {
+                    for (int c = 0; c < 4; c++) px[c] = static_cast<unsigned char>(byte(rng));
+                }
+                else if (pixelKind == 5 && x >= 8) {
+                    for (int c = 0; c < 4; c++) px[c] = row[(x - 8) * 4 + c];
+                }
+                for (int c = 0; c < 4; c++) previous[c] = px[c];
+            }
+        }
+        return image;
+    }
+
+    void checkRoundTrip(const cv::Mat& image) {
+        std::vector<unsigned char> encoded;
+        CHECK(QoiCodec::encode(image, encoded));
+        CHECK(QoiCodec::isQoi(encoded.data(), encoded.size()));
+        cv::Mat decoded = QoiCodec::decode(encoded.data(), encoded.size());
+        CHECK(TestCheck::sameImage(image, decoded));
+    }
+
+    // every prefix is decoded from its own buffer, so reading past the data shows up under a sanitizer
+    void checkTruncated(const cv::Mat& image) {
+        std::vector<unsigned char> encoded;
+        CHECK(QoiCodec::encode(image, encoded));
+        for (size_t size = 0; size < encoded.size(); size++) {
+            std::vector<unsigned char> truncated(encoded.begin(), encoded.begin() + size);
+            cv::Mat decoded = QoiCodec::decode(truncated.data(), truncated.size());
+            if (size + 8 < encoded.size()) {
+                //some pixels are missing
+                CHECK(decoded.empty());
+            }
+            else {
+                //only the end marker is cut short, which leaves the pixels intact
+                CHECK(decoded.empty() || TestCheck::sameImage(image, decoded));
+            }
+        }
+    }
+}
+
+int main() {
+    std::mt19937 rng(2024);
+
+    const cv::Size sizes[] = { cv::Size(1, 1), cv::Size(7, 3), cv::Size(63, 2), cv::Size(64, 33), cv::Size(301, 97) };
+    for (const cv::Size& size : sizes) {
+        checkRoundTrip(makeImage(size.height, size.width, rng));
+    }
+    checkRoundTrip(cv::Mat(40, 200, CV_8UC4, cv::Scalar(255, 255, 255, 255)));
+    checkRoundTrip(cv::Mat(5, 5, CV_8UC4, cv::Scalar(0, 0, 0, 0)));
+
+    //a view into a larger image is encoded from its own rows
+    cv::Mat large = makeImage(50, 80, rng);
+    checkRoundTrip(large(cv::Rect(3, 5, 41, 20)));
+
+    checkTruncated(makeImage(9, 13, rng));
+
+    //the header holds the size big endian and 4 channels
+    std::vector<unsigned char> encoded;
+    CHECK(QoiCodec::encode(makeImage(2, 300, rng), encoded));
+    CHECK(encoded.size() > 14 && encoded[0] == 'q' && encoded[1] == 'o' && encoded[2] == 'i' && encoded[3] == 'f');
+    CHECK(encoded[4] == 0 && encoded[5] == 0 && encoded[6] == 1 && encoded[7] == 44);
+    CHECK(encoded[8] == 0 && encoded[9] == 0 && encoded[10] == 0 && encoded[11] == 2);
+    CHECK(encoded[12] == 4);
+
+    //3 channel files decode as opaque RGBA
+    const unsigned char rgbFile[] = {
+        'q', 'o', 'i', 'f', 0, 0, 0, 2, 0, 0, 0, 1, 3, 0,
+        0xfe, 10, 20, 30,
+        0xfe, 40, 50, 60,
+        0, 0, 0, 0, 0, 0, 0, 1
+    };
+    cv::Mat rgb = QoiCodec::decode(rgbFile, sizeof(rgbFile));
+    CHECK(rgb.rows == 1 && rgb.cols == 2 && rgb.type() == CV_8UC4);
+    if (rgb.rows == 1 && rgb.cols == 2) {
+        const unsigned char* px = rgb.ptr<unsigned char>(0);
+        CHECK(px[0] == 10 && px[1] == 20 && px[2] == 30 && px[3] == 255);
+        CHECK(px[4] == 40 && px[5] == 50 && px[6] == 60 && px[7] == 255);
+    }
+
+    //malformed headers are rejected before anything is allocated
+    std::vector<unsigned char> malformed(rgbFile, rgbFile + sizeof(rgbFile));
+    malformed[0] = 'x';
+    CHECK(!QoiCodec::isQoi(malformed.data(), malformed.size()));
+    CHECK(QoiCodec::decode(malformed.data(), malformed.size()).empty());
+    malformed.assign(rgbFile, rgbFile + sizeof(rgbFile));
+    malformed[7] = 0;
+    CHECK(QoiCodec::decode(malformed.data(), malformed.size()).empty());
+    malformed.assign(rgbFile, rgbFile + sizeof(rgbFile));
+    malformed[4] = malformed[8] = 0xff;
+    CHECK(QoiCodec::decode(malformed.data(), malformed.size()).empty());
+    malformed.assign(rgbFile, rgbFile + sizeof(rgbFile));
+    malformed[12] = 2;
+    CHECK(QoiCodec::decode(malformed.data(), malformed.size()).empty());
+
+    //only RGBA images are encoded
+    CHECK(!QoiCodec::encode(cv::Mat(), encoded));
+    CHECK(!QoiCodec::encode(cv::Mat(4, 4, CV_8UC3, cv::Scalar(1, 2, 3)), encoded));
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstring>
+#include <iostream>
+
+#include <opencv2/core.hpp>
+
+// the checks the test executables are written with. a failed CHECK prints where it failed and the test carries on,
+// main returns TEST_RESULT() so CTest sees the failure
+namespace TestCheck {
+	inline int& failures() {
+		static int count = 0;
+		return count;
+	}
+
+	// same size, type and pixels
+	inline bool sameImage(const cv::Mat& a, const cv::Mat& b) {
+		if (a.size() != b.size() || a.type() != b.type()) return false;
+		for (int y = 0; y < a.rows; y++) {
+			if (std::memcmp(a.ptr<unsigned char>(y), b.ptr<unsigned char>(y), a.cols * a.elemSize()) != 0) return false;
+		}
+		return true;
+	}
+}
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #condition << std::endl; \
+			TestCheck::failures()++; \
+		} \
+	} while (0)
+
+#define TEST_RESULT() (TestCheck::failures() == 0 ? 0 : 1)